@@ -1,10 +1,6 @@
-#include <cstdlib>
+#include "experiments.h"
 
-void instantiationMain();
-void mutableConst();
-
-int main() {
-	instantiationMain();
-	mutableConst();
-	return EXIT_SUCCESS;
+// Experiments registered by instantiation.cpp, mutableConst.cpp, staticDispatch.cpp
+int main(int argc, char* argv[]) {
+	return run_experiments(argc, argv);
 }
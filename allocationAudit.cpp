@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+#include "allocationAudit.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Replaced global operator new/delete
+
+namespace {
+
+// Trivial: constant initialized, usable before and after the other thread_locals
+thread_local std::size_t allocations = 0;
+thread_local std::size_t bytes = 0;
+thread_local allocation_scope* innermost = nullptr;
+
+// Size of the block given by malloc (at least the requested one): the blocks have no header
+std::size_t usableSize(void* p) {
+#if defined(__APPLE__)
+	return malloc_size(p);
+#else
+	return malloc_usable_size(p);
+#endif
+}
+
+} // namespace
+
+struct allocation_hook {
+	static void allocated(void* p, std::size_t size) {
+		++allocations;
+		bytes += size;
+		if (innermost == nullptr) {
+			return;
+		}
+		const std::size_t usable = usableSize(p);
+		for (allocation_scope* scope = innermost; scope != nullptr; scope = scope->outer) {
+			allocation_stats& s = scope->s;
+			++s.allocations;
+			s.bytes += size;
+			++s.histogram[allocation_stats::size_class(size)];
+			scope->live += std::ptrdiff_t(usable);
+			if (scope->live > 0 && std::size_t(scope->live) > s.peak_bytes) {
+				s.peak_bytes = std::size_t(scope->live);
+			}
+		}
+	}
+
+	static void deallocated(void* p) {
+		if (innermost == nullptr) {
+			return;
+		}
+		const std::size_t usable = usableSize(p);
+		for (allocation_scope* scope = innermost; scope != nullptr; scope = scope->outer) {
+			++scope->s.deallocations;
+			scope->live -= std::ptrdiff_t(usable);
+		}
+	}
+
+	static void* allocate(std::size_t size, std::size_t alignment) noexcept {
+		const std::size_t blockSize = std::max<std::size_t>(size, 1); // Distinct non null pointers
+		void* p = nullptr;
+		if (alignment <= alignof(std::max_align_t)) {
+			p = std::malloc(blockSize);
+		} else {
+			p = std::aligned_alloc(alignment, (blockSize + alignment - 1) / alignment * alignment);
+		}
+		if (p != nullptr) {
+			allocated(p, size);
+		}
+		return p;
+	}
+
+	static void deallocate(void* p) noexcept {
+		if (p == nullptr) {
+			return;
+		}
+		deallocated(p);
+		std::free(p);
+	}
+};
+
+namespace {
+
+// As the standard operator new: call the new handler until the allocation succeeds, bad_alloc
+// when there is none
+void* allocateOrThrow(std::size_t size, std::size_t alignment) {
+	for (;;) {
+		if (void* p = allocation_hook::allocate(size, alignment)) {
+			return p;
+		}
+		std::new_handler handler = std::get_new_handler();
+		if (handler == nullptr) {
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+}
+
+// The nothrow forms: nullptr instead of bad_alloc (from the allocation or from the new handler)
+void* allocateOrNull(std::size_t size, std::size_t alignment) noexcept {
+	try {
+		return allocateOrThrow(size, alignment);
+	} catch (const std::bad_alloc&) {
+		return nullptr;
+	}
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+	return allocateOrThrow(size, 0);
+}
+
+void* operator new[](std::size_t size) {
+	return allocateOrThrow(size, 0);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	return allocateOrThrow(size, std::size_t(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+	return allocateOrThrow(size, std::size_t(alignment));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	return allocateOrNull(size, 0);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	return allocateOrNull(size, 0);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return allocateOrNull(size, std::size_t(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return allocateOrNull(size, std::size_t(alignment));
+}
+
+void operator delete(void* p) noexcept {
+	allocation_hook::deallocate(p);
+}
+
+void operator delete[](void* p) noexcept {
+	allocation_hook::deallocate(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	allocation_hook::deallocate(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+	allocation_hook::deallocate(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+	allocation_hook::deallocate(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+	allocation_hook::deallocate(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+	allocation_hook::deallocate(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+	allocation_hook::deallocate(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+	allocation_hook::deallocate(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+	allocation_hook::deallocate(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+	allocation_hook::deallocate(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+	allocation_hook::deallocate(p);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scopes & reports
+
+std::size_t thread_allocation_count() {
+	return allocations;
+}
+
+std::size_t thread_allocated_bytes() {
+	return bytes;
+}
+
+allocation_scope::allocation_scope() : outer(innermost) {
+	innermost = this;
+}
+
+allocation_scope::~allocation_scope() {
+	innermost = outer;
+}
+
+namespace {
+
+// " <=16:3 <=32:1 >4096:1", classes without allocation skipped
+void printHistogram(std::ostream& os, const allocation_stats& s) {
+	for (std::size_t c = 0; c < allocation_size_classes; ++c) {
+		if (s.histogram[c] != 0) {
+			os << " ";
+			if (allocation_stats::class_limit(c) != 0) {
+				os << "<=" << allocation_stats::class_limit(c);
+			} else {
+				os << ">" << allocation_stats::class_limit(c - 1);
+			}
+			os << ":" << s.histogram[c];
+		}
+	}
+}
+
+} // namespace
+
+std::size_t allocation_stats::size_class(std::size_t size) {
+	std::size_t c = 0;
+	for (std::size_t limit = 16; size > limit && c + 1 < allocation_size_classes; limit *= 2) {
+		++c;
+	}
+	return c;
+}
+
+std::size_t allocation_stats::class_limit(std::size_t c) {
+	return c + 1 < allocation_size_classes ? std::size_t(16) << c : 0;
+}
+
+void allocation_stats::print(std::ostream& os) const {
+	os << "allocations " << allocations << ", deallocations " << deallocations << ", bytes " << bytes
+	   << ", peak " << peak_bytes << ", sizes";
+	printHistogram(os, *this);
+	os << std::endl;
+}
+
+void allocation_table::print(std::ostream& os) const {
+	std::size_t width = 10;
+	for (const auto& row : rows) {
+		width = std::max(width, row.first.size());
+	}
+	os << std::left << std::setw(int(width)) << "experiment" << std::right << std::setw(8) << "allocs"
+	   << std::setw(10) << "bytes" << std::setw(10) << "peak" << "  sizes" << std::endl;
+	for (const auto& row : rows) {
+		const allocation_stats& s = row.second;
+		os << std::left << std::setw(int(width)) << row.first << std::right << std::setw(8) << s.allocations
+		   << std::setw(10) << s.bytes << std::setw(10) << s.peak_bytes << " ";
+		printHistogram(os, s);
+		os << std::endl;
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Heap allocation audit
+//
+// allocationAudit.cpp replaces the global operator new/delete (all forms) of the executables
+// linking it. Each thread counts its allocations and bytes, always: an increment, plus a test of
+// the innermost allocation_scope of the thread. Only while a scope is active does an allocation
+// or a deallocation update it (count, bytes, peak, histogram).
+//
+// {
+//     allocation_scope scope;
+//     testCopy();
+//     scope.stats().print(std::cout);
+// }
+//
+// A scope records the allocations of its thread only. Scopes nest: each active one records.
+// The blocks are malloc's ones, without header: the layout of the heap is the one of the default
+// operator new. While a scope is active, the peaks are computed from the usable sizes of the
+// blocks (malloc_usable_size), known to the unsized deletes too.
+
+constexpr std::size_t allocation_size_classes = 10;   // <= 16, 32, ... 4096 bytes, larger
+
+struct allocation_stats {
+	std::size_t allocations = 0;
+	std::size_t deallocations = 0;
+	std::size_t bytes = 0;           // Requested by the allocations
+	std::size_t peak_bytes = 0;      // Maximum of usable bytes allocated - freed, since the start
+	std::size_t histogram[allocation_size_classes] = {};
+
+	static std::size_t size_class(std::size_t size);
+	// Upper bound of the class, 0 for the last one (unbounded)
+	static std::size_t class_limit(std::size_t c);
+
+	void print(std::ostream& os) const;
+};
+
+// Totals of the calling thread since its start (no scope needed)
+std::size_t thread_allocation_count();
+std::size_t thread_allocated_bytes();
+
+// Records the allocations of the calling thread while alive
+class allocation_scope {
+public:
+	allocation_scope();
+	~allocation_scope();
+
+	allocation_scope(const allocation_scope&) = delete;
+	allocation_scope& operator=(const allocation_scope&) = delete;
+
+	const allocation_stats& stats() const { return s; }
+
+private:
+	friend struct allocation_hook;
+
+	allocation_stats s;
+	std::ptrdiff_t live = 0;         // Usable bytes allocated - freed (negative: older blocks freed)
+	allocation_scope* outer;
+};
+
+// One row per audited function (e.g. each experiment), printed as a table
+class allocation_table {
+public:
+	void add(std::string name, const allocation_stats& stats) {
+		rows.emplace_back(std::move(name), stats);
+	}
+
+	void print(std::ostream& os) const;
+
+private:
+	std::vector<std::pair<std::string, allocation_stats>> rows;
+};
@@ -0,0 +1,14 @@
+#include "allocationCounter.h"
+#include "../allocationAudit.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Totals of the calling thread, counted by the global operator new of allocationAudit.cpp
+// (per thread counter: no contention in the multi-threaded benchmarks)
+
+std::size_t bench::allocationCount() {
+	return thread_allocation_count();
+}
+
+std::size_t bench::allocatedBytes() {
+	return thread_allocated_bytes();
+}
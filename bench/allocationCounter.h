@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+
+namespace bench {
+
+// Number of calls to the global operator new made by the calling thread
+// (operator new is replaced, see allocationAudit.h)
+std::size_t allocationCount();
+
+// Number of bytes requested to the global operator new by the calling thread
+std::size_t allocatedBytes();
+
+} // namespace bench
@@ -0,0 +1,387 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#include "baseline.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// File format:
+// {"format": "CppExperiments bench baseline", "version": 1, "compiler": "...", "build": "Release",
+//  "results": [{"name": "...", "median_ns": ..., "p99_ns": ..., "allocs_per_op": ...,
+//               "copies_per_op": ..., "moves_per_op": ..., "ops_per_second": ..., "samples_ns": [...]}, ...]}
+
+// Build type of the bench (CMake configuration)
+#ifndef CPPEXPERIMENTS_BUILD_TYPE
+#define CPPEXPERIMENTS_BUILD_TYPE "unknown"
+#endif
+
+namespace {
+
+const char* const compilerName = __VERSION__;
+const char* const buildName = CPPEXPERIMENTS_BUILD_TYPE;
+const char* const formatName = "CppExperiments bench baseline";
+const double alpha = 0.01;
+const std::size_t minTestedSamples = 5;
+
+std::string jsonString(const std::string& s) {
+	std::string quoted = "\"";
+	for (char c : s) {
+		if (c == '"' || c == '\\') {
+			quoted += '\\';
+		}
+		quoted += c;
+	}
+	return quoted + "\"";
+}
+
+// Minimal JSON reader: what saveBaseline writes (objects, arrays, strings, numbers, literals)
+struct Json {
+	enum Type { null, boolean, number, string, array, object };
+
+	Type type = null;
+	double value = 0;
+	std::string text;
+	std::vector<Json> items;
+	std::map<std::string, Json> members;
+
+	const Json* member(const std::string& key) const {
+		auto it = members.find(key);
+		return it != members.end() ? &it->second : nullptr;
+	}
+
+	double numberOr(const std::string& key, double otherwise) const {
+		const Json* m = member(key);
+		return m != nullptr && m->type == number ? m->value : otherwise;
+	}
+};
+
+class JsonParser {
+	const std::string& s;
+	std::size_t i = 0;
+
+	void skipSpaces() {
+		while (i < s.size() && std::isspace(static_cast<unsigned char>(s[i]))) {
+			++i;
+		}
+	}
+
+	bool consume(char c) {
+		skipSpaces();
+		if (i < s.size() && s[i] == c) {
+			++i;
+			return true;
+		}
+		return false;
+	}
+
+	bool parseString(std::string& out) {
+		if (!consume('"')) {
+			return false;
+		}
+		while (i < s.size() && s[i] != '"') {
+			char c = s[i++];
+			if (c == '\\' && i < s.size()) {
+				c = s[i++];
+				switch (c) {
+				case 'n': c = '\n'; break;
+				case 't': c = '\t'; break;
+				case 'r': c = '\r'; break;
+				case 'b': c = '\b'; break;
+				case 'f': c = '\f'; break;
+				case 'u': i += 4; c = '?'; break; // Not written by saveBaseline
+				default: break;                   // " \ /
+				}
+			}
+			out += c;
+		}
+		return consume('"');
+	}
+
+public:
+	explicit JsonParser(const std::string& s) : s(s) {}
+
+	bool parse(Json& out) {
+		skipSpaces();
+		if (i >= s.size()) {
+			return false;
+		}
+		const char c = s[i];
+		if (c == '{') {
+			out.type = Json::object;
+			++i;
+			if (consume('}')) {
+				return true;
+			}
+			do {
+				std::string key;
+				if (!parseString(key) || !consume(':') || !parse(out.members[key])) {
+					return false;
+				}
+			} while (consume(','));
+			return consume('}');
+		}
+		if (c == '[') {
+			out.type = Json::array;
+			++i;
+			if (consume(']')) {
+				return true;
+			}
+			do {
+				out.items.emplace_back();
+				if (!parse(out.items.back())) {
+					return false;
+				}
+			} while (consume(','));
+			return consume(']');
+		}
+		if (c == '"') {
+			out.type = Json::string;
+			return parseString(out.text);
+		}
+		for (const char* literal : {"true", "false", "null"}) {
+			const std::string l(literal);
+			if (s.compare(i, l.size(), l) == 0) {
+				i += l.size();
+				out.type = l == "null" ? Json::null : Json::boolean;
+				out.value = l == "true";
+				return true;
+			}
+		}
+		char* end = nullptr;
+		out.type = Json::number;
+		out.value = std::strtod(s.c_str() + i, &end);
+		if (end == s.c_str() + i) {
+			return false;
+		}
+		i = std::size_t(end - s.c_str());
+		return true;
+	}
+
+	bool atEnd() {
+		skipSpaces();
+		return i == s.size();
+	}
+};
+
+// Probability that 'current' is not slower than 'base' (one-sided Mann-Whitney U test, normal
+// approximation with tie correction)
+double slowerPValue(const std::vector<double>& current, const std::vector<double>& base) {
+	const double n1 = double(current.size());
+	const double n2 = double(base.size());
+	double u = 0;
+	for (double c : current) {
+		for (double b : base) {
+			u += c > b ? 1 : c == b ? 0.5 : 0;
+		}
+	}
+	// Tie correction: sum of t^3 - t over the groups of equal values of the pooled samples
+	std::vector<double> pooled(current);
+	pooled.insert(pooled.end(), base.begin(), base.end());
+	std::sort(pooled.begin(), pooled.end());
+	double ties = 0;
+	for (std::size_t k = 0; k < pooled.size();) {
+		std::size_t j = k;
+		while (j < pooled.size() && pooled[j] == pooled[k]) {
+			++j;
+		}
+		const double t = double(j - k);
+		ties += t * t * t - t;
+		k = j;
+	}
+	const double n = n1 + n2;
+	const double variance = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)));
+	if (variance <= 0) {
+		return 1;
+	}
+	const double z = (u - n1 * n2 / 2 - 0.5) / std::sqrt(variance);
+	return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+double percentChange(double now, double before) {
+	return before != 0 ? 100 * (now - before) / before : 0;
+}
+
+// A count of the instrumentation (per call) grew beyond the threshold
+bool countRegressed(double now, double before, double thresholdPercent) {
+	return now > before * (1 + thresholdPercent / 100) + 0.01;
+}
+
+} // namespace
+
+bool bench::saveBaseline(const std::string& path, const std::vector<Result>& results, std::ostream& errors) {
+	std::ofstream out(path);
+	if (!out) {
+		errors << "cannot write the baseline " << path << std::endl;
+		return false;
+	}
+	out << "{\"format\": " << jsonString(formatName) << ", \"version\": " << baseline_version
+	    << ", \"compiler\": " << jsonString(compilerName) << ", \"build\": " << jsonString(buildName)
+	    << ",\n \"results\": [" << std::setprecision(9);
+	for (std::size_t i = 0; i < results.size(); ++i) {
+		const Result& r = results[i];
+		out << (i == 0 ? "\n" : ",\n") << "  {\"name\": " << jsonString(r.name) << ", \"iterations\": " << r.iterations
+		    << ", \"median_ns\": " << r.medianNs << ", \"p90_ns\": " << r.p90Ns << ", \"p99_ns\": " << r.p99Ns
+		    << ", \"allocs_per_op\": " << r.allocationsPerOp << ", \"copies_per_op\": " << r.copiesPerOp
+		    << ", \"moves_per_op\": " << r.movesPerOp << ", \"ops_per_second\": " << r.opsPerSecond
+		    << ", \"samples_ns\": [";
+		for (std::size_t s = 0; s < r.sampleNs.size(); ++s) {
+			out << (s == 0 ? "" : ", ") << r.sampleNs[s];
+		}
+		out << "]}";
+	}
+	out << "\n]}" << std::endl;
+	if (!out) {
+		errors << "cannot write the baseline " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+int bench::compareWithBaseline(const std::string& path, const std::vector<Result>& results, double thresholdPercent,
+                               bool force, std::ostream& os) {
+	os << std::defaultfloat << std::setprecision(6);
+	std::ifstream in(path);
+	if (!in) {
+		os << "cannot read the baseline " << path << std::endl;
+		return -1;
+	}
+	std::stringstream content;
+	content << in.rdbuf();
+	const std::string text = content.str();
+	JsonParser parser(text);
+	Json root;
+	if (!parser.parse(root) || !parser.atEnd() || root.type != Json::object) {
+		os << path << ": not JSON" << std::endl;
+		return -1;
+	}
+	const Json* format = root.member("format");
+	const Json* results0 = root.member("results");
+	if (format == nullptr || format->text != formatName || results0 == nullptr || results0->type != Json::array) {
+		os << path << ": not a baseline" << std::endl;
+		return -1;
+	}
+	if (root.numberOr("version", 0) != baseline_version) {
+		os << path << ": baseline version " << root.numberOr("version", 0) << ", expected " << baseline_version
+		   << " (save it again)" << std::endl;
+		return -1;
+	}
+
+	const struct {
+		const char* key;
+		const char* current;
+	} builds[] = {
+		{"compiler", compilerName},
+		{"build", buildName},
+	};
+	for (const auto& field : builds) {
+		const Json* recorded = root.member(field.key);
+		if (recorded == nullptr || recorded->type != Json::string) {
+			os << "warning: " << path << ": " << field.key << " not recorded, cannot check it" << std::endl;
+		} else if (recorded->text != field.current) {
+			os << (force ? "warning: " : "") << path << ": " << field.key << " \"" << recorded->text
+			   << "\", this bench: \"" << field.current << "\"";
+			if (!force) {
+				os << " (the timings are not comparable, --force to compare anyway)" << std::endl;
+				return -1;
+			}
+			os << std::endl;
+		}
+	}
+
+	std::map<std::string, const Json*> base;
+	for (const Json& r : results0->items) {
+		const Json* name = r.member("name");
+		if (name != nullptr) {
+			base[name->text] = &r;
+		}
+	}
+
+	int regressions = 0;
+	os << "Comparison with " << path << " (threshold " << thresholdPercent << "%, p < " << alpha << ")" << std::endl;
+	for (const Result& r : results) {
+		auto found = base.find(r.name);
+		if (found == base.end()) {
+			os << "  new        " << r.name << std::endl;
+			continue;
+		}
+		const Json& b = *found->second;
+		base.erase(found);
+
+		std::vector<std::string> reasons;
+		bool improved = false;
+		std::ostringstream detail;
+		detail << std::fixed << std::setprecision(1);
+
+		std::vector<double> baseSamples;
+		if (const Json* samples = b.member("samples_ns")) {
+			for (const Json& s : samples->items) {
+				baseSamples.push_back(s.value);
+			}
+		}
+		// Throughput (runThreads) or time of one call; the samples are times in both cases
+		const bool throughput = r.opsPerSecond != 0;
+		const double before = throughput ? b.numberOr("ops_per_second", 0) : b.numberOr("median_ns", 0);
+		const double now = throughput ? r.opsPerSecond : r.medianNs;
+		const double change = percentChange(now, before);
+		const double slowdown = throughput ? -change : change;
+		if (throughput) {
+			detail << before / 1e6 << " -> " << now / 1e6 << " Mops/s (";
+		} else {
+			detail << before << " -> " << now << " ns (";
+		}
+		detail << std::showpos << change << std::noshowpos << "%";
+		if (r.sampleNs.size() >= minTestedSamples && baseSamples.size() >= minTestedSamples) {
+			const double slower = slowerPValue(r.sampleNs, baseSamples);
+			const double faster = slowerPValue(baseSamples, r.sampleNs);
+			detail << std::setprecision(4) << ", p " << std::min(slower, faster) << std::setprecision(1);
+			if (slowdown > thresholdPercent && slower < alpha) {
+				reasons.push_back(throughput ? "throughput" : "time");
+			} else if (slowdown < -thresholdPercent && faster < alpha) {
+				improved = true;
+			}
+		} else {
+			detail << ", too few samples to test";
+		}
+		detail << ")";
+
+		const struct {
+			const char* name;
+			double now;
+			double before;
+		} counts[] = {
+			{"allocs", r.allocationsPerOp, b.numberOr("allocs_per_op", 0)},
+			{"copies", r.copiesPerOp, b.numberOr("copies_per_op", 0)},
+			{"moves", r.movesPerOp, b.numberOr("moves_per_op", 0)},
+		};
+		for (const auto& c : counts) {
+			if (countRegressed(c.now, c.before, thresholdPercent)) {
+				reasons.push_back(c.name);
+				detail << std::setprecision(2) << "  " << c.name << "/op " << c.before << " -> " << c.now
+				       << std::setprecision(1);
+			}
+		}
+
+		if (!reasons.empty()) {
+			++regressions;
+			os << "  REGRESSION " << r.name << ": " << detail.str() << " [";
+			for (std::size_t i = 0; i < reasons.size(); ++i) {
+				os << (i == 0 ? "" : ", ") << reasons[i];
+			}
+			os << "]" << std::endl;
+		} else {
+			os << (improved ? "  improved   " : "  same       ") << r.name << ": " << detail.str() << std::endl;
+		}
+	}
+	for (const auto& missing : base) {
+		if (enabled(missing.first)) { // Not only filtered out
+			os << "  missing    " << missing.first << " (not run)" << std::endl;
+		}
+	}
+	os << regressions << " regression(s)" << std::endl;
+	return regressions;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Baselines: results saved to a JSON file, compared with a later run of the same machine
+//
+// bench --save-baseline=base.json               (e.g. on the main branch)
+// bench --baseline=base.json --threshold=5      (on the change: exit status 1 on regression)
+//
+// A case regresses when
+// - its median time (its median throughput for runThreads) worsens by more than the threshold (%)
+//   and the samples of the two runs differ significantly (one-sided Mann-Whitney U test, p < 0.01:
+//   noise alone rarely passes it)
+// - or its allocations, copies or moves per call grow by more than the threshold (+ 0.01: the
+//   counts are averages, e.g. of amortized vector growth). These are deterministic: a lost copy
+//   elision or a new allocation is a regression whatever the timings.
+// Cases missing from either run are listed, not counted.
+// The timings of another compiler or build type mean nothing: such a baseline is refused, unless
+// 'force' (then only a warning is printed).
+
+namespace bench {
+
+constexpr int baseline_version = 1;
+
+// Return false (and print why on 'errors') when the file cannot be written
+bool saveBaseline(const std::string& path, const std::vector<Result>& results, std::ostream& errors);
+
+// Print the comparison on 'os'. Return the number of regressions, -1 when the baseline cannot be
+// read (missing file, other format or version) or, without 'force', comes from another compiler or
+// build type.
+int compareWithBaseline(const std::string& path, const std::vector<Result>& results, double thresholdPercent,
+                        bool force, std::ostream& os);
+
+} // namespace bench
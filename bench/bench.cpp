@@ -0,0 +1,207 @@
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+
+#include "baseline.h"
+#include "bench.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Options, statistics and output of the harness
+
+namespace {
+
+bench::Options currentOptions;
+std::vector<bench::Result> results; // Kept for the JSON output and the baseline
+bool csvHeaderWritten = false;
+
+void usage(const char* program) {
+	std::cerr << "usage: " << program << " [--format=text|csv|json] [--filter=SUBSTRING] [--samples=N]"
+	          << " [--min-time-ms=X] [--save-baseline=FILE] [--baseline=FILE [--threshold=PERCENT] [--force]]" << std::endl;
+}
+
+bool startsWith(const std::string& s, const char* prefix, std::string& value) {
+	const std::string p(prefix);
+	if (s.compare(0, p.size(), p) != 0) {
+		return false;
+	}
+	value = s.substr(p.size());
+	return true;
+}
+
+// Whole value, as parseCount of experiments.cpp
+bool parseCount(const std::string& value, std::size_t& count) {
+	const char* end = value.data() + value.size();
+	std::from_chars_result r = std::from_chars(value.data(), end, count);
+	return !value.empty() && r.ec == std::errc() && r.ptr == end;
+}
+
+// Whole value, finite
+bool parseNumber(const std::string& value, double& number) {
+	char* end = nullptr;
+	number = std::strtod(value.c_str(), &end);
+	return !value.empty() && end == value.c_str() + value.size() && std::isfinite(number);
+}
+
+// Nearest rank of a sorted sample
+double percentile(const std::vector<double>& sorted, double p) {
+	const std::size_t rank = std::size_t(std::ceil(p / 100 * sorted.size()));
+	return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+}
+
+std::string jsonString(const std::string& s) {
+	std::string quoted = "\"";
+	for (char c : s) {
+		if (c == '"' || c == '\\') {
+			quoted += '\\';
+		}
+		quoted += c;
+	}
+	return quoted + "\"";
+}
+
+// Names may contain commas ("poly_collection<H1, H2>")
+std::string csvString(const std::string& s) {
+	std::string quoted = "\"";
+	for (char c : s) {
+		if (c == '"') {
+			quoted += '"';
+		}
+		quoted += c;
+	}
+	return quoted + "\"";
+}
+
+void printText(const bench::Result& r) {
+	std::ostream& os = std::cout;
+	os << std::left << std::setw(56) << r.name << std::right << std::fixed;
+	if (r.opsPerSecond != 0) {
+		os << std::setw(12) << std::setprecision(1) << r.opsPerSecond / 1e6 << " Mops/s" << std::endl;
+		return;
+	}
+	os << std::setw(12) << std::setprecision(1) << r.medianNs << " ns/op"
+	   << "  p90 " << std::setw(12) << r.p90Ns << "  p99 " << std::setw(12) << r.p99Ns
+	   << std::setw(10) << std::setprecision(2) << r.allocationsPerOp << " allocs/op";
+	if (r.copiesPerOp != 0 || r.movesPerOp != 0) {
+		os << std::setw(8) << r.copiesPerOp << " copies/op" << std::setw(8) << r.movesPerOp << " moves/op";
+	}
+	os << std::endl;
+}
+
+void printCsv(const bench::Result& r) {
+	if (!csvHeaderWritten) {
+		std::cout << "name,samples,iterations,mean_ns,median_ns,p90_ns,p99_ns,min_ns,allocs_per_op,"
+		             "copies_per_op,moves_per_op,ops_per_second" << std::endl;
+		csvHeaderWritten = true;
+	}
+	std::cout << csvString(r.name) << ',' << r.samples << ',' << r.iterations << std::setprecision(6)
+	          << ',' << r.meanNs << ',' << r.medianNs << ',' << r.p90Ns << ',' << r.p99Ns << ',' << r.minNs
+	          << ',' << r.allocationsPerOp << ',' << r.copiesPerOp << ',' << r.movesPerOp << ','
+	          << r.opsPerSecond << std::endl;
+}
+
+} // namespace
+
+bool bench::configure(int argc, char* argv[]) {
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		std::string value;
+		if (startsWith(arg, "--format=", value)) {
+			if (value == "text") {
+				currentOptions.format = Options::text;
+			} else if (value == "csv") {
+				currentOptions.format = Options::csv;
+			} else if (value == "json") {
+				currentOptions.format = Options::json;
+			} else {
+				usage(argv[0]);
+				return false;
+			}
+		} else if (startsWith(arg, "--filter=", value)) {
+			currentOptions.filter = value;
+		} else if (startsWith(arg, "--samples=", value) && parseCount(value, currentOptions.samples) &&
+		           currentOptions.samples > 0) {
+		} else if (startsWith(arg, "--min-time-ms=", value) && parseNumber(value, currentOptions.minSampleMs) &&
+		           currentOptions.minSampleMs > 0) {
+		} else if (startsWith(arg, "--save-baseline=", value) && !value.empty()) {
+			currentOptions.saveBaseline = value;
+		} else if (startsWith(arg, "--baseline=", value) && !value.empty()) {
+			currentOptions.baseline = value;
+		} else if (startsWith(arg, "--threshold=", value) && parseNumber(value, currentOptions.threshold) &&
+		           currentOptions.threshold >= 0) {
+		} else if (arg == "--force") {
+			currentOptions.force = true;
+		} else {
+			usage(argv[0]);
+			return false;
+		}
+	}
+	return true;
+}
+
+const bench::Options& bench::options() {
+	return currentOptions;
+}
+
+bool bench::enabled(const std::string& name) {
+	return name.find(currentOptions.filter) != std::string::npos;
+}
+
+std::ostream& bench::notes() {
+	return currentOptions.format == Options::text ? std::cout : std::cerr;
+}
+
+void bench::report(Result& result, std::vector<double> nsPerOp) {
+	std::sort(nsPerOp.begin(), nsPerOp.end());
+	result.samples = nsPerOp.size();
+	result.meanNs = std::accumulate(nsPerOp.begin(), nsPerOp.end(), 0.0) / nsPerOp.size();
+	result.medianNs = percentile(nsPerOp, 50);
+	result.p90Ns = percentile(nsPerOp, 90);
+	result.p99Ns = percentile(nsPerOp, 99);
+	result.minNs = nsPerOp.front();
+	if (result.threads != 0) {
+		result.opsPerSecond = result.threads * 1e9 / result.medianNs;
+	}
+	result.sampleNs = std::move(nsPerOp);
+
+	switch (currentOptions.format) {
+	case Options::text:
+		printText(result);
+		break;
+	case Options::csv:
+		printCsv(result);
+		break;
+	case Options::json: // By finish()
+		break;
+	}
+	results.push_back(result);
+}
+
+int bench::finish() {
+	int status = EXIT_SUCCESS;
+	if (!currentOptions.saveBaseline.empty() && !saveBaseline(currentOptions.saveBaseline, results, std::cerr)) {
+		status = EXIT_FAILURE;
+	}
+	if (!currentOptions.baseline.empty() &&
+	    compareWithBaseline(currentOptions.baseline, results, currentOptions.threshold, currentOptions.force,
+	                        notes()) != 0) {
+		status = EXIT_FAILURE;
+	}
+	if (currentOptions.format != Options::json) {
+		return status;
+	}
+	std::cout << "[" << std::setprecision(6);
+	for (std::size_t i = 0; i < results.size(); ++i) {
+		const Result& r = results[i];
+		std::cout << (i == 0 ? "\n" : ",\n") << "  {\"name\": " << jsonString(r.name)
+		          << ", \"samples\": " << r.samples << ", \"iterations\": " << r.iterations
+		          << ", \"mean_ns\": " << r.meanNs << ", \"median_ns\": " << r.medianNs
+		          << ", \"p90_ns\": " << r.p90Ns << ", \"p99_ns\": " << r.p99Ns << ", \"min_ns\": " << r.minNs
+		          << ", \"allocs_per_op\": " << r.allocationsPerOp << ", \"copies_per_op\": " << r.copiesPerOp
+		          << ", \"moves_per_op\": " << r.movesPerOp << ", \"ops_per_second\": " << r.opsPerSecond << "}";
+	}
+	std::cout << "\n]" << std::endl;
+	return status;
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "allocationCounter.h"
+#include "../lifecycleCounters.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Micro-benchmark harness (no external dependency)
+//
+// bench::run("group/case", [&] { ... }) calibrates the number of iterations of a sample so that it
+// lasts at least --min-time-ms, warms up with one sample, then times --samples samples. The result
+// is the distribution of the time of one call over the samples (median, p90, p99), with the mean
+// numbers of allocations and of copies/moves of the instrumented types per call.
+// Results are printed as text (default), CSV or JSON (--format), for the cases containing --filter.
+// They can be saved as a baseline, or compared with one (baseline.h).
+
+namespace bench {
+
+// Force the compiler to consider 'value' as read: its computation cannot be optimized away
+template <class T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const void* sink;
+	sink = &value;
+#endif
+}
+
+// Force the compiler to consider every memory write as observed
+inline void clobberMemory() {
+#if defined(__GNUC__)
+	asm volatile("" : : : "memory");
+#else
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+struct Options {
+	enum Format { text, csv, json };
+
+	Format format = text;
+	std::string filter;         // Substring of the names of the cases to run, all when empty
+	std::size_t samples = 15;
+	double minSampleMs = 2;
+	std::string saveBaseline;   // Path of the baseline to write, none when empty
+	std::string baseline;       // Path of the baseline to compare with, none when empty
+	double threshold = 5;       // Regression threshold of the comparison (%)
+	bool force = false;         // Compare with a baseline of another compiler or build type
+};
+
+// Parse the command line (--format=text|csv|json --filter=... --samples=N --min-time-ms=X
+// --save-baseline=FILE --baseline=FILE --threshold=PERCENT --force).
+// Print the usage and return false when invalid.
+bool configure(int argc, char* argv[]);
+const Options& options();
+
+// Whether the case is selected by --filter
+bool enabled(const std::string& name);
+
+// Comments of the benchmarks: std::cout with the text format, std::cerr otherwise (stdout is data)
+std::ostream& notes();
+
+struct Result {
+	std::string name;
+	std::size_t samples = 0;
+	std::size_t iterations = 0;          // Per sample
+	double meanNs = 0;                   // Per call
+	double medianNs = 0;
+	double p90Ns = 0;
+	double p99Ns = 0;
+	double minNs = 0;
+	double allocationsPerOp = 0;
+	double copiesPerOp = 0;              // Copies and copy assignments of the instrumented types
+	double movesPerOp = 0;               // Moves and move assignments
+	unsigned threads = 0;                // runThreads only
+	double opsPerSecond = 0;             // runThreads only: median throughput of all the threads
+	std::vector<double> sampleNs;        // Time of one call of each sample, sorted
+};
+
+// Compute the statistics of 'nsPerOp' (one value per sample) into 'result', print and record it.
+// With 'threads', nsPerOp is the time of one operation of a thread: it also gives the throughput.
+void report(Result& result, std::vector<double> nsPerOp);
+
+// Print the recorded results when they are written at the end (JSON), save or compare the
+// baseline. Return the exit status: failure on regression or when the baseline cannot be used.
+int finish();
+
+// Calibrate, warm up, time. Return the median time of one call in ns (0 when filtered out).
+template <class Fn>
+double run(const std::string& name, Fn&& fn) {
+	using clock = std::chrono::steady_clock;
+
+	if (!enabled(name)) {
+		return 0;
+	}
+
+	auto sample = [&fn](std::size_t iterations) {
+		clock::time_point start = clock::now();
+		for (std::size_t i = 0; i < iterations; ++i) {
+			fn();
+		}
+		return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+	};
+
+	// Calibration (and first warm-up): grow the iterations until a sample is long enough
+	const double minSampleNs = options().minSampleMs * 1e6;
+	std::size_t iterations = 1;
+	double ns = sample(iterations);
+	while (ns < minSampleNs) {
+		iterations = ns * 2 > minSampleNs ? std::size_t(iterations * minSampleNs / ns) + 1 : iterations * 2;
+		ns = sample(iterations);
+	}
+	sample(iterations);
+
+	Result result;
+	result.name = name;
+	result.iterations = iterations;
+	std::vector<double> nsPerOp;
+	nsPerOp.reserve(options().samples); // No allocation while measuring
+	lifecycle_scope lifecycle;
+	std::size_t startAllocations = allocationCount();
+	for (std::size_t s = 0; s < options().samples; ++s) {
+		nsPerOp.push_back(sample(iterations) / iterations);
+	}
+	const double calls = double(iterations) * options().samples;
+	result.allocationsPerOp = (allocationCount() - startAllocations) / calls;
+	lifecycle_counts events = lifecycle.delta();
+	result.copiesPerOp = (events.copies() + events.copyAssignments()) / calls;
+	result.movesPerOp = (events.moves() + events.moveAssignments()) / calls;
+
+	report(result, std::move(nsPerOp));
+	return result.medianNs;
+}
+
+// Run fn(threadIndex) on 'threads' threads started together, each one doing 'opsPerThread'
+// operations, --samples times: prepare() (untimed) restores the state fn needs before each sample.
+// Print the median throughput of all the threads and return it in operations/s.
+template <class Fn, class Prepare>
+double runThreads(const std::string& name, unsigned threads, std::size_t opsPerThread, Fn&& fn, Prepare&& prepare) {
+	using clock = std::chrono::steady_clock;
+
+	const std::string fullName = name + " x" + std::to_string(threads);
+	if (!enabled(fullName)) {
+		return 0;
+	}
+
+	auto sample = [&] {
+		prepare();
+		std::atomic<unsigned> ready(0);
+		std::atomic<bool> go(false);
+		std::vector<std::thread> workers;
+		for (unsigned t = 0; t < threads; ++t) {
+			workers.emplace_back([&, t] {
+				ready.fetch_add(1);
+				while (!go.load(std::memory_order_acquire)) {
+					std::this_thread::yield();
+				}
+				fn(t);
+			});
+		}
+		while (ready.load() != threads) {
+			std::this_thread::yield();
+		}
+		clock::time_point start = clock::now();
+		go.store(true, std::memory_order_release);
+		for (std::thread& w : workers) {
+			w.join();
+		}
+		return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+	};
+
+	Result result;
+	result.name = fullName;
+	result.iterations = opsPerThread;
+	result.threads = threads;
+	std::vector<double> nsPerOp; // Time of one operation of a thread
+	for (std::size_t s = 0; s < options().samples; ++s) {
+		nsPerOp.push_back(sample() / opsPerThread);
+	}
+	report(result, std::move(nsPerOp));
+	return result.opsPerSecond;
+}
+
+template <class Fn>
+double runThreads(const std::string& name, unsigned threads, std::size_t opsPerThread, Fn&& fn) {
+	return runThreads(name, threads, opsPerThread, std::forward<Fn>(fn), [] {});
+}
+
+// 1, 2, 4... up to the number of hardware threads (at least 4)
+inline std::vector<unsigned> threadCounts(unsigned max = 0) {
+	if (max == 0) {
+		max = std::max(4u, std::thread::hardware_concurrency());
+	}
+	std::vector<unsigned> counts;
+	for (unsigned t = 1; t <= max; t *= 2) {
+		counts.push_back(t);
+	}
+	return counts;
+}
+
+} // namespace bench
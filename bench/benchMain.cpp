@@ -0,0 +1,55 @@
+#include <cstdlib>
+
+#include "bench.h"
+
+void copyMoveBench();
+void uniqueValueBench();
+void uniqueFunctionBench();
+void rvoBench();
+void cascadeBench();
+void stringAppendBench();
+void fixedStringBench();
+void stringSsoBench();
+void ownerPtrBench();
+void slotMapBench();
+void intrusivePtrBench();
+void refcountContentionBench();
+void sharedStringBench();
+void internedStringBench();
+void lifecycleBench();
+void retentionBench();
+void dispatchBench();
+void polyCollectionBench();
+void poolAllocatorBench();
+void synchronizedMemberBench();
+void lazyBench();
+void workStealingPoolBench();
+
+int main(int argc, char* argv[]) {
+	if (!bench::configure(argc, argv)) {
+		return EXIT_FAILURE;
+	}
+	copyMoveBench();
+	uniqueValueBench();
+	uniqueFunctionBench();
+	rvoBench();
+	cascadeBench();
+	stringAppendBench();
+	fixedStringBench();
+	stringSsoBench();
+	ownerPtrBench();
+	slotMapBench();
+	intrusivePtrBench();
+	refcountContentionBench();
+	sharedStringBench();
+	internedStringBench();
+	lifecycleBench();
+	retentionBench();
+	dispatchBench();
+	polyCollectionBench();
+	poolAllocatorBench();
+	synchronizedMemberBench();
+	lazyBench();
+	workStealingPoolBench();
+	return bench::finish();
+}
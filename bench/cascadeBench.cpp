@@ -0,0 +1,51 @@
+#include <utility>
+
+#include "bench.h"
+#include "../instrumentedTypes.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copies and moves of MS through outer/inner (testCascadeMoveSemantics), same functions without
+// their text. The copies/op and moves/op columns give the table of the experiment.
+
+namespace {
+
+[[gnu::noinline]] MS buildMS() {
+	return MS();
+}
+
+[[gnu::noinline]] void inner(MS ms) {
+	ms.f();
+	bench::doNotOptimize(ms);
+}
+
+[[gnu::noinline]] void innerRvalue(MS&& ms) {
+	ms.f();
+	bench::doNotOptimize(ms);
+}
+
+[[gnu::noinline]] void outer(MS ms) {
+	inner(ms);
+	inner(std::move(ms));
+	innerRvalue(std::move(ms));
+}
+
+[[gnu::noinline]] void outerRvalue(MS&& ms) {
+	inner(ms);
+	inner(std::move(ms));
+	innerRvalue(std::move(ms));
+}
+
+} // namespace
+
+void cascadeBench() {
+	MS ms;
+	bench::run("cascade/1  outer(ms)", [&] { outer(ms); });
+	bench::run("cascade/2  outer(move(ms))", [&] { outer(std::move(ms)); });
+	bench::run("cascade/3a outer(MS())", [] { outer(MS()); });
+	bench::run("cascade/3b outer(move(MS()))", [] { outer(std::move(MS())); });
+	bench::run("cascade/3c outer(buildMS())", [] { outer(buildMS()); });
+	bench::run("cascade/3d outer(move(buildMS()))", [] { outer(std::move(buildMS())); });
+	bench::run("cascade/4  outerRvalue(move(ms))", [&] { outerRvalue(std::move(ms)); });
+	bench::run("cascade/5a outerRvalue(MS())", [] { outerRvalue(MS()); });
+	bench::run("cascade/5c outerRvalue(buildMS())", [] { outerRvalue(buildMS()); });
+}
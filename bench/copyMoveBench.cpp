@@ -0,0 +1,57 @@
+#include <string>
+#include <utility>
+
+#include "bench.h"
+#include "../instrumentedTypes.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copy of A (testCopy) vs move of B (testMove)
+// A copies its std::string (allocation when too long for its inline buffer), B moves its pointer.
+
+namespace {
+
+[[gnu::noinline]] void useCopyConstructor(A a) {
+	bench::doNotOptimize(a.a.data());
+}
+
+void benchA(const std::string& text, const std::string& suffix) {
+	A a1(text);
+	A a2(text);
+	bench::run("copyMove/A copy constructor" + suffix, [&] {
+		A copy(a1);
+		bench::doNotOptimize(copy.a.data());
+	});
+	bench::run("copyMove/A copy assignment" + suffix, [&] {
+		a2 = a1;
+		bench::doNotOptimize(a2.a.data());
+	});
+	bench::run("copyMove/A pass by value" + suffix, [&] {
+		useCopyConstructor(a1);
+	});
+}
+
+} // namespace
+
+void copyMoveBench() {
+	benchA("someString", "/short");
+	benchA("a string too long to be stored inline by std::string", "/long");
+
+	bench::run("copyMove/B construction", [] {
+		B b(5);
+		bench::doNotOptimize(b.b);
+	});
+	B b1(5);
+	bench::run("copyMove/B move constructor", [&] {
+		B b2(std::move(b1));
+		bench::doNotOptimize(b2.b);
+		b1.b = b2.b; // Give the int back without a second move
+		b2.b = nullptr;
+	});
+	B b3(7);
+	bench::run("copyMove/B move assignment", [&] {
+		b3 = std::move(b1);
+		b1.b = b3.b;
+		b3.b = nullptr;
+		bench::doNotOptimize(b1.b);
+	});
+}
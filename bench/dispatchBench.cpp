@@ -0,0 +1,312 @@
+#include <cstddef>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "bench.h"
+#include "../inplacePoly.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// f() over 10^6 H1/H2 objects (random mix, H2 is an H1) with 4 dispatch styles:
+// - virtual: calls through H, as the 'new H2' of virtualMethodsBehavior()
+// - final: calls through the final type (devirtualized, as F1 final)
+// - variant: std::visit
+// - CRTP: calls through the CRTP base
+// final and CRTP need the static type of each object: in a mixed sequence it is the index of a
+// variant, as for the variant style.
+//
+// Every style walks the same sequence of objects, in 3 layouts:
+// - indirect: each object behind a pointer (vector<unique_ptr<...>>), in the order of the sequence
+// - contiguous: the objects in place in one vector (inplace_poly for virtual), same order
+// - segregated: one contiguous vector per type (all the H1 then all the H2): no dispatch left to
+//   predict, the static type is the one of the vector
+//
+// "inlined" is a heuristic: the call is considered inlined when it costs less than half of a call
+// to a function that could not be inlined (the noinline reference below), objects in cache.
+
+namespace {
+
+const std::size_t objectCount = 1000000;
+
+// Virtual
+
+struct H {
+	virtual ~H() = default;
+	virtual int f() const = 0;
+	int value = 1;
+};
+
+struct H1 : H {
+	int f() const override { return value + 1; }
+};
+
+struct H2 : H1 {
+	int f() const override { return value * 2; }
+};
+
+// final: the leaves are final, FH2 is still an H1
+
+struct FH1Base : H {
+	int f() const override { return value + 1; }
+};
+
+struct FH1 final : FH1Base {};
+
+struct FH2 final : FH1Base {
+	int f() const override { return value * 2; }
+};
+
+// variant
+
+struct VH1 {
+	int value = 1;
+	int f() const { return value + 1; }
+};
+
+struct VH2 : VH1 {
+	int f() const { return value * 2; }
+};
+
+// CRTP (as in staticDispatch.cpp)
+
+template <class Derived>
+struct CH {
+	int value = 1;
+	int f() const { return static_cast<const Derived*>(this)->fImpl(); }
+};
+
+// 'Derived' = void for a CH1 object, otherwise the type inheriting from CH1T
+template <class Derived = void>
+struct CH1T : CH<std::conditional_t<std::is_void_v<Derived>, CH1T<>, Derived>> {
+	int fImpl() const { return this->value + 1; }
+};
+
+using CH1 = CH1T<>;
+
+struct CH2 : CH1T<CH2> {
+	int fImpl() const { return value * 2; }
+};
+
+// noinline reference
+
+struct NH {
+	int value = 1;
+	[[gnu::noinline]] int f() const { return value + 1; }
+};
+
+// Styles: 'mixed' holds an H1 or an H2 in place, callMixed dispatches on it. callOne calls an object
+// of known type (segregated layout).
+
+template <class Mixed, class T1, class T2>
+Mixed makeMixed(bool second) {
+	return second ? Mixed(T2()) : Mixed(T1());
+}
+
+struct Virtual {
+	using T1 = H1;
+	using T2 = H2;
+	using mixed = inplace_poly<H, sizeof(H2), alignof(H2)>;
+	static int callMixed(const mixed& h) { return h->f(); }
+	template <class T>
+	static int callOne(const T& h) { return static_cast<const H&>(h).f(); }
+};
+
+struct Final {
+	using T1 = FH1;
+	using T2 = FH2;
+	using mixed = std::variant<FH1, FH2>;
+	static int callMixed(const mixed& h) {
+		return std::visit([](const auto& concrete) { return concrete.f(); }, h);
+	}
+	template <class T>
+	static int callOne(const T& h) { return h.f(); }
+};
+
+struct Variant {
+	using T1 = VH1;
+	using T2 = VH2;
+	using mixed = std::variant<VH1, VH2>;
+	static int callMixed(const mixed& h) {
+		return std::visit([](const auto& concrete) { return concrete.f(); }, h);
+	}
+	template <class T>
+	static int callOne(const T& h) { return h.f(); }
+};
+
+struct Crtp {
+	using T1 = CH1;
+	using T2 = CH2;
+	using mixed = std::variant<CH1, CH2>;
+	template <class T>
+	static int callOne(const T& h) {
+		const CH<T>& base = h;
+		return base.f();
+	}
+	static int callMixed(const mixed& h) {
+		return std::visit([](const auto& concrete) { return callOne(concrete); }, h);
+	}
+};
+
+// Layouts of the sequence ('true' for an H2)
+
+template <class Style>
+struct Indirect {
+	static constexpr const char* name = "indirect";
+	static constexpr std::size_t objectSize = sizeof(typename Style::mixed);
+
+	std::vector<std::unique_ptr<typename Style::mixed>> objects;
+
+	explicit Indirect(const std::vector<bool>& sequence) {
+		using M = typename Style::mixed;
+		for (bool second : sequence) {
+			objects.push_back(std::make_unique<M>(makeMixed<M, typename Style::T1, typename Style::T2>(second)));
+		}
+	}
+
+	long sum() const {
+		long sum = 0;
+		for (const std::unique_ptr<typename Style::mixed>& h : objects) {
+			sum += Style::callMixed(*h);
+		}
+		return sum;
+	}
+};
+
+template <class Style>
+struct Contiguous {
+	static constexpr const char* name = "contiguous";
+	static constexpr std::size_t objectSize = sizeof(typename Style::mixed);
+
+	std::vector<typename Style::mixed> objects;
+
+	explicit Contiguous(const std::vector<bool>& sequence) {
+		using M = typename Style::mixed;
+		objects.reserve(sequence.size());
+		for (bool second : sequence) {
+			objects.push_back(makeMixed<M, typename Style::T1, typename Style::T2>(second));
+		}
+	}
+
+	long sum() const {
+		long sum = 0;
+		for (const typename Style::mixed& h : objects) {
+			sum += Style::callMixed(h);
+		}
+		return sum;
+	}
+};
+
+template <class Style>
+struct Segregated {
+	static constexpr const char* name = "segregated";
+	static constexpr std::size_t objectSize = sizeof(typename Style::T2);
+
+	std::vector<typename Style::T1> first;
+	std::vector<typename Style::T2> second;
+
+	explicit Segregated(const std::vector<bool>& sequence) {
+		for (bool isSecond : sequence) {
+			if (isSecond) {
+				second.emplace_back();
+			} else {
+				first.emplace_back();
+			}
+		}
+	}
+
+	template <class T>
+	static long sumOf(const std::vector<T>& objects) {
+		long sum = 0;
+		for (const T& h : objects) {
+			sum += Style::callOne(h);
+		}
+		return sum;
+	}
+
+	long sum() const {
+		return sumOf(first) + sumOf(second);
+	}
+};
+
+// Random but reproducible H1/H2 mix
+std::vector<bool> randomSequence(std::size_t count) {
+	std::mt19937 random(42);
+	std::vector<bool> sequence(count);
+	for (std::size_t i = 0; i < count; ++i) {
+		sequence[i] = random() % 2 != 0;
+	}
+	return sequence;
+}
+
+void printNotes(double ns, double hotNs, double referenceHotNs, std::size_t objectSize) {
+	bench::notes() << "    " << std::fixed << std::setprecision(2) << ns << " ns/call, " << hotNs
+	               << " ns/call in cache, " << objectSize << " bytes/object, inlined: "
+	               << (referenceHotNs == 0 ? "n/a" : hotNs < referenceHotNs / 2 ? "yes" : "no") << std::endl;
+}
+
+// The objects are only built when the case is selected
+template <template <class> class Layout, class Style>
+void benchCase(const char* style, const std::vector<bool>& sequence, const std::vector<bool>& hotSequence,
+               double referenceHotNs) {
+	const std::string name = std::string(Layout<Style>::name) + "/" + style;
+	if (!bench::enabled("dispatch/" + name) && !bench::enabled("dispatch/hot/" + name)) {
+		return;
+	}
+	const Layout<Style> objects(sequence);
+	const Layout<Style> hot(hotSequence);
+	double ns = bench::run("dispatch/" + name, [&] { bench::doNotOptimize(objects.sum()); }) / sequence.size();
+	double hotNs = bench::run("dispatch/hot/" + name,
+	                          [&] { bench::doNotOptimize(hot.sum()); }) / hotSequence.size();
+	if (ns == 0 || hotNs == 0) {
+		return; // Filtered out
+	}
+	printNotes(ns, hotNs, referenceHotNs, Layout<Style>::objectSize);
+}
+
+template <template <class> class Layout>
+void benchLayout(const std::vector<bool>& sequence, const std::vector<bool>& hotSequence,
+                 double referenceHotNs) {
+	benchCase<Layout, Virtual>("virtual", sequence, hotSequence, referenceHotNs);
+	benchCase<Layout, Final>("final", sequence, hotSequence, referenceHotNs);
+	benchCase<Layout, Variant>("variant", sequence, hotSequence, referenceHotNs);
+	benchCase<Layout, Crtp>("CRTP", sequence, hotSequence, referenceHotNs);
+}
+
+long noinlineCalls(const std::vector<NH>& objects) {
+	long sum = 0;
+	for (const NH& h : objects) {
+		sum += h.f();
+	}
+	return sum;
+}
+
+} // namespace
+
+void dispatchBench() {
+	// 10^6 objects for the figures, 1024 objects (in L1 cache) for the inlining heuristic:
+	// the memory bandwidth could make a call look cheap
+	const std::vector<bool> sequence = randomSequence(objectCount);
+	const std::vector<bool> hotSequence = randomSequence(1024);
+
+	double referenceHotNs = 0;
+	{
+		const std::vector<NH> reference(objectCount);
+		const std::vector<NH> hot(hotSequence.size());
+		double ns = bench::run("dispatch/noinline reference",
+		                       [&] { bench::doNotOptimize(noinlineCalls(reference)); }) / objectCount;
+		referenceHotNs = bench::run("dispatch/hot/noinline reference",
+		                            [&] { bench::doNotOptimize(noinlineCalls(hot)); }) / hot.size();
+		if (ns != 0 && referenceHotNs != 0) {
+			printNotes(ns, referenceHotNs, referenceHotNs, sizeof(NH));
+		}
+	}
+
+	benchLayout<Indirect>(sequence, hotSequence, referenceHotNs);
+	benchLayout<Contiguous>(sequence, hotSequence, referenceHotNs);
+	benchLayout<Segregated>(sequence, hotSequence, referenceHotNs);
+}
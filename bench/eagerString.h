@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstring>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Baseline: the string of mutableConst.cpp before string_concat and the small string optimization,
+// without its cout tracing. Only a char* is stored: every operation calls strlen, every value is
+// on the heap and every append allocates a new buffer and copies both sides.
+
+class eager_string {
+    char *data;
+
+public:
+
+    eager_string(const char *p) {
+        size_t size = std::strlen(p) + 1;
+        data = new char[size];
+        std::memcpy(data, p, size);
+    }
+
+    ~eager_string() {
+        delete[] data;
+    }
+
+    eager_string(const eager_string &that) {
+        size_t size = std::strlen(that.data) + 1;
+        data = new char[size];
+        std::memcpy(data, that.data, size);
+    }
+
+    eager_string(eager_string &&that) {
+        data = that.data;
+        that.data = nullptr;
+    }
+
+    eager_string& operator=(const eager_string& that) = delete;
+
+    eager_string& operator=(eager_string&& that) {
+        std::swap(data, that.data);
+        return *this;
+    }
+
+    eager_string& append(const char *p) && {
+        eager_string tmp(data, p);
+        std::swap(data, tmp.data);
+        return *this;
+    }
+
+    eager_string append(const char *p) const & {
+        return eager_string(data, p);
+    }
+
+    const char* c_str() const {
+        return data;
+    }
+
+private:
+
+    eager_string(const char *start, const char *end) {
+        size_t size = std::strlen(start) + std::strlen(end) + 1;
+        data = new char[size];
+        std::strcpy(data, start);
+        std::strcat(data, end);
+    }
+};
@@ -0,0 +1,42 @@
+#include "bench.h"
+#include "../fixedString.h"
+#include "../immutableString.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Literal chains of moveSemanticsThis() built at run time (string_concat) vs at compile time
+// (fixed_string, see fixedString.h), short (inline) and long (heap or borrowed) results
+
+namespace {
+
+constexpr auto shortChain = fixed_string("s").append("1...").append("2...");
+constexpr auto longChain = fixed_string("s").append("1...").append("2...").append(" and a tail too long for the inline buffer");
+
+} // namespace
+
+void fixedStringBench() {
+	bench::run("fixedString/short/runtime chain", [] {
+		string s = string("s").append("1...").append("2...");
+		bench::doNotOptimize(s.c_str());
+	});
+	bench::run("fixedString/short/fixed_string str()", [] {
+		string s = shortChain.str();
+		bench::doNotOptimize(s.c_str());
+	});
+	bench::run("fixedString/short/fixed_string borrow()", [] {
+		string s = shortChain.borrow();
+		bench::doNotOptimize(s.c_str());
+	});
+
+	bench::run("fixedString/long/runtime chain", [] {
+		string s = string("s").append("1...").append("2...").append(" and a tail too long for the inline buffer");
+		bench::doNotOptimize(s.c_str());
+	});
+	bench::run("fixedString/long/fixed_string str()", [] {
+		string s = longChain.str();
+		bench::doNotOptimize(s.c_str());
+	});
+	bench::run("fixedString/long/fixed_string borrow()", [] {
+		string s = longChain.borrow();
+		bench::doNotOptimize(s.c_str());
+	});
+}
@@ -0,0 +1,112 @@
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bench.h"
+#include "../internedString.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Corpus of many keys with few distinct values (field names, tags, identifiers...):
+// - memory of the corpus: std::string per key vs interned_string (a pointer) + one entry per value
+// - unordered_map lookup: std::string keys (hash and compare the chars) vs interned_string keys
+//   (cached hash, pointer compare), and interning the key first (the key comes from outside)
+// - interning from 1 to N threads (the pool is sharded)
+
+namespace {
+
+const std::size_t corpusSize = 200000;
+const std::size_t distinctValues = 1000;
+
+// Too long to be stored inline by std::string
+std::string value(std::size_t i) {
+	return "customer/region-eu-west/account/" + std::to_string(100000 + i) + "/profile";
+}
+
+// Skewed, reproducible draw of the values: a few are very frequent
+std::vector<std::string> makeCorpus() {
+	std::vector<std::string> corpus;
+	corpus.reserve(corpusSize);
+	std::uint64_t x = 42;
+	for (std::size_t i = 0; i < corpusSize; ++i) {
+		x = x * 6364136223846793005u + 1442695040888963407u;
+		const std::size_t r = std::size_t(x >> 33) % distinctValues;
+		corpus.push_back(value(r * r / distinctValues));
+	}
+	return corpus;
+}
+
+void memory(const std::vector<std::string>& corpus) {
+	std::vector<std::string> copies;
+	copies.reserve(corpus.size());
+	std::size_t startBytes = bench::allocatedBytes();
+	for (const std::string& s : corpus) {
+		copies.push_back(s);
+	}
+	const double stringBytes = double(bench::allocatedBytes() - startBytes) + sizeof(std::string) * corpus.size();
+
+	std::vector<interned_string> handles;
+	handles.reserve(corpus.size());
+	const interned_string::pool_statistics before = interned_string::statistics();
+	for (const std::string& s : corpus) {
+		handles.emplace_back(s);
+	}
+	const interned_string::pool_statistics after = interned_string::statistics();
+	const double internedBytes = double(after.bytes - before.bytes) + sizeof(interned_string) * corpus.size();
+
+	bench::notes() << "internedString/memory: " << corpus.size() << " keys, " << after.values - before.values
+	               << " distinct" << std::endl
+	               << std::fixed << std::setprecision(1)
+	               << "    std::string: " << stringBytes / corpus.size() << " bytes/key" << std::endl
+	               << "    interned_string: " << internedBytes / corpus.size() << " bytes/key ("
+	               << std::setprecision(0) << 100 * (1 - internedBytes / stringBytes) << "% saved)" << std::endl;
+}
+
+void lookup(const std::vector<std::string>& corpus) {
+	std::unordered_map<std::string, int> stringMap;
+	std::unordered_map<interned_string, int> internedMap;
+	for (std::size_t i = 0; i < distinctValues; ++i) {
+		stringMap[value(i)] = int(i);
+		internedMap[interned_string(value(i))] = int(i);
+	}
+	std::vector<interned_string> handles(corpus.begin(), corpus.end());
+
+	std::size_t i = 0;
+	const double stringNs = bench::run("internedString/lookup/std::string", [&] {
+		bench::doNotOptimize(stringMap.find(corpus[i++ % corpusSize])->second);
+	});
+	const double internedNs = bench::run("internedString/lookup/interned_string", [&] {
+		bench::doNotOptimize(internedMap.find(handles[i++ % corpusSize])->second);
+	});
+	bench::run("internedString/lookup/intern + interned_string", [&] {
+		bench::doNotOptimize(internedMap.find(interned_string(corpus[i++ % corpusSize]))->second);
+	});
+	if (stringNs != 0 && internedNs != 0) {
+		bench::notes() << "    lookup speedup: " << std::fixed << std::setprecision(1) << stringNs / internedNs << "x"
+		               << std::endl;
+	}
+}
+
+void concurrentInterning(const std::vector<std::string>& corpus) {
+	const std::size_t opsPerThread = corpusSize;
+	for (unsigned threads : bench::threadCounts()) {
+		bench::runThreads("internedString/intern", threads, opsPerThread, [&](unsigned t) {
+			for (std::size_t i = 0; i < opsPerThread; ++i) {
+				bench::doNotOptimize(interned_string(corpus[(i + t * 7919) % corpusSize]));
+			}
+		});
+	}
+}
+
+} // namespace
+
+void internedStringBench() {
+	const std::vector<std::string> corpus = makeCorpus();
+	if (bench::enabled("internedString/memory")) {
+		memory(corpus);
+	}
+	lookup(corpus);
+	concurrentInterning(corpus);
+}
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "perfCounter.h"
+#include "../instrumentedTypes.h"
+#include "../intrusivePtr.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Walk of a large graph (binary tree) of H1/H2 nodes through shared_ptr and intrusive_ptr
+// The nodes are the H1 and H2 of the experiments (instrumentedTypes.h) with the links of the graph,
+// and the count for intrusive_ptr (ref_counted, as CountedH2 in instantiation.cpp).
+// The nodes are linked in random order: each step of the walk is a jump in memory.
+// The walk copies the child pointers on its stack, as most code holding smart pointers does.
+// The graph of a case is built only when the case is selected.
+
+namespace {
+
+const std::size_t nodeCount = 1 << 20;
+
+// Links of a node, its H1 or H2 reached through h()
+struct SharedNode {
+	virtual ~SharedNode() = default;
+	virtual H& h() = 0;
+	std::shared_ptr<SharedNode> children[2];
+};
+
+template <class Counter>
+struct IntrusiveNode : ref_counted<IntrusiveNode<Counter>, Counter> {
+	virtual ~IntrusiveNode() = default;
+	virtual H& h() = 0;
+	intrusive_ptr<IntrusiveNode> children[2];
+};
+
+template <class Node, class HType>
+struct NodeOf final : Node, HType {
+	H& h() override { return *this; }
+};
+
+// Return the root, the other nodes are only owned through their parent
+template <class Ptr, class Make>
+Ptr buildGraph(Make make) {
+	std::vector<Ptr> nodes;
+	nodes.reserve(nodeCount);
+	for (std::size_t i = 0; i < nodeCount; ++i) {
+		nodes.push_back(make(i % 2 == 0));
+	}
+	std::shuffle(nodes.begin(), nodes.end(), std::mt19937(42));
+	for (std::size_t i = 0; 2 * i + 2 < nodeCount; ++i) {
+		nodes[i]->children[0] = nodes[2 * i + 1];
+		nodes[i]->children[1] = nodes[2 * i + 2];
+	}
+	return nodes[0];
+}
+
+template <class Ptr>
+long walk(const Ptr& root) {
+	std::vector<Ptr> stack;
+	stack.reserve(64);
+	stack.push_back(root);
+	long count = 0;
+	while (!stack.empty()) {
+		Ptr node = std::move(stack.back());
+		stack.pop_back();
+		node->h().f();
+		++count;
+		for (const Ptr& child : node->children) {
+			if (child) {
+				stack.push_back(child);
+			}
+		}
+	}
+	return count;
+}
+
+template <class Ptr, class Make>
+void benchGraph(const std::string& name, Make make) {
+	const std::string fullName = "intrusivePtr/walk 2^20 nodes/" + name;
+	if (!bench::enabled(fullName)) {
+		return; // Filtered out: no graph
+	}
+
+	std::size_t startAllocations = bench::allocationCount();
+	std::size_t startBytes = bench::allocatedBytes();
+	Ptr root = buildGraph<Ptr>(make);
+	// The vector of buildGraph is counted too: 1 allocation, 8 or 16 bytes per node
+	double allocations = double(bench::allocationCount() - startAllocations) / nodeCount;
+	double bytes = double(bench::allocatedBytes() - startBytes) / nodeCount;
+
+	bench::CacheMissCounter cacheMisses;
+	cacheMisses.start();
+	bench::doNotOptimize(walk(root));
+	double misses = double(cacheMisses.stop()) / nodeCount;
+
+	bench::run(fullName, [&] { bench::doNotOptimize(walk(root)); });
+
+	bench::notes() << "    allocs/node: " << std::setprecision(2) << allocations << "  bytes/node: " << bytes
+	          << "  sizeof pointer: " << sizeof(Ptr) << "  cache misses/node: ";
+	if (cacheMisses.valid()) {
+		bench::notes() << misses << std::endl;
+	} else {
+		bench::notes() << "n/a (perf events unavailable)" << std::endl;
+	}
+}
+
+template <class Counter>
+intrusive_ptr<IntrusiveNode<Counter>> makeIntrusive(bool h1) {
+	if (h1) {
+		return make_intrusive<NodeOf<IntrusiveNode<Counter>, H1>>();
+	}
+	return make_intrusive<NodeOf<IntrusiveNode<Counter>, H2>>();
+}
+
+} // namespace
+
+void intrusivePtrBench() {
+	using SharedH1 = NodeOf<SharedNode, H1>;
+	using SharedH2 = NodeOf<SharedNode, H2>;
+	benchGraph<std::shared_ptr<SharedNode>>("shared_ptr(new)", [](bool h1) {
+		return h1 ? std::shared_ptr<SharedNode>(new SharedH1) : std::shared_ptr<SharedNode>(new SharedH2);
+	});
+	benchGraph<std::shared_ptr<SharedNode>>("make_shared", [](bool h1) {
+		return h1 ? std::shared_ptr<SharedNode>(std::make_shared<SharedH1>())
+		          : std::shared_ptr<SharedNode>(std::make_shared<SharedH2>());
+	});
+	benchGraph<intrusive_ptr<IntrusiveNode<single_thread_counter>>>("intrusive_ptr single_thread",
+	                                                                makeIntrusive<single_thread_counter>);
+	benchGraph<intrusive_ptr<IntrusiveNode<thread_safe_counter>>>("intrusive_ptr thread_safe",
+	                                                              makeIntrusive<thread_safe_counter>);
+}
@@ -0,0 +1,78 @@
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "../lazy.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cached value of a const getter: lazy<T> (acquire load once computed) vs the hand-rolled
+// mutable mutex + mutable optional (lock on every read)
+// - hot: the value is computed, 1 to N threads read it
+// - cold: N threads walk the same array of not yet computed objects, racing for each computation
+
+namespace {
+
+const std::size_t opsPerThread = 1000000;
+const std::size_t coldObjects = 20000;
+
+template <class T>
+class MutexCache {
+	mutable std::mutex m;
+	mutable std::optional<T> value;
+
+public:
+	template <class F>
+	const T& get(F&& f) const {
+		std::lock_guard<std::mutex> lk(m);
+		if (!value) {
+			value.emplace(f());
+		}
+		return *value;
+	}
+};
+
+// A few hundred ns of work, unsigned: the wrap around is defined
+std::uint64_t expensive(std::size_t seed) {
+	std::uint64_t sum = seed;
+	for (unsigned i = 0; i < 200; ++i) {
+		sum = sum * 31 + i;
+		bench::doNotOptimize(sum);
+	}
+	return sum;
+}
+
+template <class Cache>
+void benchCache(const std::string& name) {
+	Cache hot;
+	hot.get([] { return expensive(0); });
+	bench::run("lazy/hot read/" + name, [&] {
+		bench::doNotOptimize(hot.get([] { return expensive(0); }));
+	});
+	for (unsigned threads : bench::threadCounts()) {
+		bench::runThreads("lazy/hot read/" + name, threads, opsPerThread, [&](unsigned) {
+			for (std::size_t i = 0; i < opsPerThread; ++i) {
+				bench::doNotOptimize(hot.get([] { return expensive(0); }));
+			}
+		});
+	}
+
+	for (unsigned threads : bench::threadCounts()) {
+		std::vector<Cache> cold;
+		bench::runThreads("lazy/cold start/" + name, threads, coldObjects, [&](unsigned) {
+			for (std::size_t i = 0; i < coldObjects; ++i) {
+				bench::doNotOptimize(cold[i].get([i] { return expensive(i); }));
+			}
+		}, [&] { cold = std::vector<Cache>(coldObjects); }); // Cold again for each sample
+	}
+}
+
+} // namespace
+
+void lazyBench() {
+	benchCache<lazy<std::uint64_t>>("lazy<uint64_t>");
+	benchCache<MutexCache<std::uint64_t>>("mutex");
+}
@@ -0,0 +1,57 @@
+#include <ostream>
+#include <utility>
+
+#include "bench.h"
+#include "../instrumentedTypes.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cost of the copy/move counters of the experiment types (see lifecycleCounters.h)
+// counted only (the benchmarks) vs counted + text written to a stream in error state (the cost of
+// the former cout tracing, without the terminal)
+
+namespace {
+
+const std::size_t opsPerThread = 5000000;
+
+[[gnu::noinline]] void byValue(MS ms) {
+	ms.f();
+	bench::doNotOptimize(ms);
+}
+
+void benchCopies(const char* mode) {
+	MS ms;
+	bench::run(std::string("lifecycle/MS copy/") + mode, [&] {
+		byValue(ms);
+	});
+	bench::run(std::string("lifecycle/MS move/") + mode, [&] {
+		byValue(std::move(ms));
+	});
+}
+
+} // namespace
+
+void lifecycleBench() {
+	benchCopies("counted");
+	{
+		std::ostream muted(nullptr); // No buffer: badbit, every write fails at once
+		lifecycle_text_reporter trace(muted);
+		benchCopies("counted + text");
+	}
+
+	// The harness reports the events of one call: 1 copy, 1 move
+	MS ms;
+	bench::run("lifecycle/MS copy + move", [&] {
+		MS copy(ms);
+		byValue(std::move(copy));
+	});
+
+	// One block of counters per thread: no shared cache line between the threads
+	for (unsigned threads : bench::threadCounts()) {
+		bench::runThreads("lifecycle/MS copy (per-thread counters)", threads, opsPerThread, [](unsigned) {
+			MS local;
+			for (std::size_t i = 0; i < opsPerThread; ++i) {
+				byValue(local);
+			}
+		});
+	}
+}
@@ -0,0 +1,83 @@
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "bench.h"
+#include "../ownerPtr.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// owner_ptr/ref_ptr policies vs unique_ptr (uniquePtr()) and shared_ptr (virtualMethodsBehavior())
+
+namespace {
+
+template <class Policy>
+[[gnu::noinline]] std::size_t byValue(ref_ptr<std::string, Policy> ref) {
+	return ref->size();
+}
+
+[[gnu::noinline]] std::size_t byValue(std::shared_ptr<std::string> shared) {
+	return shared->size();
+}
+
+[[gnu::noinline]] std::size_t byValue(std::string* raw) {
+	return raw->size();
+}
+
+template <class Policy>
+void benchPolicy(const std::string& policy) {
+	bench::run("ownerPtr/create/owner_ptr<" + policy + ">", [] {
+		owner_ptr<std::string, Policy> owner = make_owner<std::string, Policy>("aa");
+		bench::doNotOptimize(owner.get());
+	});
+
+	owner_ptr<std::string, Policy> owner = make_owner<std::string, Policy>("aa");
+	bench::run("ownerPtr/reference/ref_ptr<" + policy + ">", [&] {
+		ref_ptr<std::string, Policy> ref = owner;
+		bench::doNotOptimize(ref);
+	});
+	ref_ptr<std::string, Policy> ref = owner;
+	bench::run("ownerPtr/pass by value/ref_ptr<" + policy + ">", [&] {
+		bench::doNotOptimize(byValue(ref));
+	});
+}
+
+} // namespace
+
+void ownerPtrBench() {
+	benchPolicy<unchecked_policy>("unchecked");
+	benchPolicy<counting_policy>("counting");
+	benchPolicy<atomic_counting_policy>("atomic_counting");
+
+	bench::run("ownerPtr/create/unique_ptr", [] {
+		std::unique_ptr<std::string> unique = std::make_unique<std::string>("aa");
+		bench::doNotOptimize(unique.get());
+	});
+	bench::run("ownerPtr/create/shared_ptr", [] {
+		std::shared_ptr<std::string> shared = std::make_shared<std::string>("aa");
+		bench::doNotOptimize(shared.get());
+	});
+
+	std::unique_ptr<std::string> unique = std::make_unique<std::string>("aa");
+	std::shared_ptr<std::string> shared = std::make_shared<std::string>("aa");
+	bench::run("ownerPtr/reference/raw pointer", [&] {
+		std::string* raw = unique.get();
+		bench::doNotOptimize(raw);
+	});
+	bench::run("ownerPtr/reference/shared_ptr", [&] {
+		std::shared_ptr<std::string> copy = shared;
+		bench::doNotOptimize(copy);
+	});
+	bench::run("ownerPtr/pass by value/raw pointer", [&] {
+		bench::doNotOptimize(byValue(unique.get()));
+	});
+	bench::run("ownerPtr/pass by value/shared_ptr", [&] {
+		bench::doNotOptimize(byValue(shared));
+	});
+
+	if (bench::enabled("ownerPtr/")) {
+		bench::notes() << "sizeof ref_ptr<unchecked> / ref_ptr<counting> / shared_ptr: "
+		               << sizeof(ref_ptr<std::string, unchecked_policy>) << " / "
+		               << sizeof(ref_ptr<std::string, counting_policy>) << " / "
+		               << sizeof(std::shared_ptr<std::string>) << std::endl;
+	}
+}
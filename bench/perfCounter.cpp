@@ -0,0 +1,56 @@
+#include "perfCounter.h"
+
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+
+bench::CacheMissCounter::CacheMissCounter() {
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = PERF_COUNT_HW_CACHE_MISSES;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+bench::CacheMissCounter::~CacheMissCounter() {
+	if (fd >= 0) {
+		close(fd);
+	}
+}
+
+void bench::CacheMissCounter::start() {
+	if (fd >= 0) {
+		ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+	}
+}
+
+std::uint64_t bench::CacheMissCounter::stop() {
+	std::uint64_t count = 0;
+	if (fd >= 0) {
+		ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+		if (read(fd, &count, sizeof(count)) != sizeof(count)) {
+			count = 0;
+		}
+	}
+	return count;
+}
+
+#else
+
+bench::CacheMissCounter::CacheMissCounter() {}
+bench::CacheMissCounter::~CacheMissCounter() {}
+void bench::CacheMissCounter::start() {}
+std::uint64_t bench::CacheMissCounter::stop() { return 0; }
+
+#endif
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+namespace bench {
+
+// Hardware cache misses of the calling thread (Linux perf events).
+// Unavailable (no permission, virtual machine, other OS): valid() is false and count() is 0.
+class CacheMissCounter {
+	int fd = -1;
+
+public:
+	CacheMissCounter();
+	~CacheMissCounter();
+
+	CacheMissCounter(const CacheMissCounter&) = delete;
+	CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+	bool valid() const { return fd >= 0; }
+
+	void start();
+	std::uint64_t stop();
+};
+
+} // namespace bench
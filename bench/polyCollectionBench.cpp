@@ -0,0 +1,80 @@
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "bench.h"
+#include "../polyCollection.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sum of f() over 10^4 to 10^7 H1/H2 objects (random mix):
+// vector<unique_ptr<H>> vs poly_collection<H> (virtual calls) vs poly_collection<H> (concrete type)
+
+namespace {
+
+struct H {
+	virtual ~H() = default;
+	virtual int f() const { return 0; } // Defined for the qualified call H::f() of the generic lambda
+	int value = 1;
+};
+
+struct H1 : H {
+	int f() const override { return value + 1; }
+};
+
+struct H2 : H1 {
+	int f() const override { return value * 2; }
+};
+
+// The objects are only built when a case of this count is selected
+void benchSize(std::size_t count) {
+	const std::string suffix = "/" + std::to_string(count);
+	if (!bench::enabled("polyCollection/vector<unique_ptr<H>>" + suffix) &&
+	    !bench::enabled("polyCollection/poly_collection virtual" + suffix) &&
+	    !bench::enabled("polyCollection/poly_collection<H1, H2>" + suffix)) {
+		return;
+	}
+
+	std::vector<std::unique_ptr<H>> pointers;
+	poly_collection<H> collection;
+	std::mt19937 random(42);
+	for (std::size_t i = 0; i < count; ++i) {
+		if (random() % 2 == 0) {
+			pointers.push_back(std::make_unique<H1>());
+			collection.emplace<H1>();
+		} else {
+			pointers.push_back(std::make_unique<H2>());
+			collection.emplace<H2>();
+		}
+	}
+
+	bench::run("polyCollection/vector<unique_ptr<H>>" + suffix, [&] {
+		long sum = 0;
+		for (const std::unique_ptr<H>& h : pointers) {
+			sum += h->f();
+		}
+		bench::doNotOptimize(sum);
+	});
+	bench::run("polyCollection/poly_collection virtual" + suffix, [&] {
+		long sum = 0;
+		collection.for_each([&](const H& h) { sum += h.f(); });
+		bench::doNotOptimize(sum);
+	});
+	bench::run("polyCollection/poly_collection<H1, H2>" + suffix, [&] {
+		long sum = 0;
+		collection.for_each<H1, H2>([&](const auto& h) {
+			sum += h.std::decay_t<decltype(h)>::f(); // Concrete type: not virtual, inlined
+		});
+		bench::doNotOptimize(sum);
+	});
+}
+
+} // namespace
+
+void polyCollectionBench() {
+	for (std::size_t count = 10000; count <= 10000000; count *= 10) {
+		benchSize(count);
+	}
+}
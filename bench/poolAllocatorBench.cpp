@@ -0,0 +1,50 @@
+#include <cstddef>
+#include <new>
+#include <string>
+
+#include "bench.h"
+#include "../poolAllocator.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Allocation/free throughput of small blocks (4 to 256 bytes, as the 'new int' of B) on 1 to N
+// threads: small_object_pool vs the default operator new.
+// Each thread allocates 64 blocks then frees them, in a loop. The operator new of the bench
+// executable counts the allocations per thread (see allocationAudit.cpp): a few % on its figures.
+
+namespace {
+
+const std::size_t opsPerThread = 4000000;
+const std::size_t live = 64;
+
+std::size_t sizeOf(std::size_t i) {
+	static const std::size_t sizes[] = {4, 8, 16, 24, 32, 48, 64, 128, 256};
+	return sizes[i % (sizeof(sizes) / sizeof(sizes[0]))];
+}
+
+template <class Allocate, class Deallocate>
+void allocFree(Allocate allocate, Deallocate deallocate) {
+	void* blocks[live];
+	for (std::size_t n = 0; n < opsPerThread; n += live) {
+		for (std::size_t i = 0; i < live; ++i) {
+			blocks[i] = allocate(sizeOf(i));
+			bench::doNotOptimize(blocks[i]);
+		}
+		for (std::size_t i = live; i-- > 0;) {
+			deallocate(blocks[i], sizeOf(i));
+		}
+	}
+}
+
+} // namespace
+
+void poolAllocatorBench() {
+	for (unsigned threads : bench::threadCounts()) {
+		bench::runThreads("poolAllocator/operator new", threads, opsPerThread, [](unsigned) {
+			allocFree([](std::size_t size) { return ::operator new(size); },
+			          [](void* p, std::size_t size) { ::operator delete(p, size); });
+		});
+		bench::runThreads("poolAllocator/small_object_pool", threads, opsPerThread, [](unsigned) {
+			allocFree(small_object_pool::allocate, small_object_pool::deallocate);
+		});
+	}
+}
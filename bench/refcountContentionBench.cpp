@@ -0,0 +1,111 @@
+#include <cstddef>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+
+#include "bench.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Smart pointers shared by 1 to N threads (the single threaded uniquePtr() and
+// thinkingAboutSmartPointer.txt do not show it): every copy of a shared_ptr increments and
+// decrements the same atomic count, whose cache line bounces between the cores.
+// Each workload reads the object; "efficiency" is the throughput of N threads / (N x 1 thread).
+// Passing by const& or moving (see testCascadeMoveSemantics) avoids the count.
+
+namespace {
+
+const std::size_t opsPerThread = 1000000;
+
+struct Object {
+	long value = 1;
+};
+
+[[gnu::noinline]] long byValue(std::shared_ptr<Object> p) {
+	return p->value;
+}
+
+[[gnu::noinline]] long byConstRef(const std::shared_ptr<Object>& p) {
+	return p->value;
+}
+
+[[gnu::noinline]] std::shared_ptr<Object> byValueMovedBack(std::shared_ptr<Object> p) {
+	bench::doNotOptimize(p->value);
+	return p;
+}
+
+[[gnu::noinline]] std::unique_ptr<Object> byValueMovedBack(std::unique_ptr<Object> p) {
+	bench::doNotOptimize(p->value);
+	return p;
+}
+
+[[gnu::noinline]] long borrow(const Object* p) {
+	return p->value;
+}
+
+// fn(threadIndex) does opsPerThread operations: run it on 1 to N threads
+template <class Fn>
+void scaling(const std::string& name, Fn fn) {
+	double single = 0;
+	for (unsigned threads : bench::threadCounts()) {
+		const double opsPerSecond = bench::runThreads("refcount/" + name, threads, opsPerThread, fn);
+		if (threads == 1) {
+			single = opsPerSecond;
+		} else if (opsPerSecond != 0 && single != 0) {
+			bench::notes() << "    efficiency: " << std::fixed << std::setprecision(0)
+			               << 100 * opsPerSecond / (threads * single) << "%" << std::endl;
+		}
+	}
+}
+
+} // namespace
+
+void refcountContentionBench() {
+	const std::shared_ptr<Object> shared = std::make_shared<Object>();
+	const std::weak_ptr<Object> weak = shared;
+
+	scaling("shared_ptr copy + drop", [&](unsigned) {
+		for (std::size_t i = 0; i < opsPerThread; ++i) {
+			std::shared_ptr<Object> copy = shared;
+			bench::doNotOptimize(copy->value);
+		}
+	});
+	scaling("shared_ptr pass by value", [&](unsigned) {
+		for (std::size_t i = 0; i < opsPerThread; ++i) {
+			bench::doNotOptimize(byValue(shared));
+		}
+	});
+	scaling("shared_ptr pass by const&", [&](unsigned) {
+		for (std::size_t i = 0; i < opsPerThread; ++i) {
+			bench::doNotOptimize(byConstRef(shared));
+		}
+	});
+	// One copy per thread, then moved in and out: no count update in the loop
+	scaling("shared_ptr pass by value, moved", [&](unsigned) {
+		std::shared_ptr<Object> local = shared;
+		for (std::size_t i = 0; i < opsPerThread; ++i) {
+			local = byValueMovedBack(std::move(local));
+		}
+	});
+	scaling("weak_ptr::lock", [&](unsigned) {
+		for (std::size_t i = 0; i < opsPerThread; ++i) {
+			std::shared_ptr<Object> locked = weak.lock();
+			bench::doNotOptimize(locked->value);
+		}
+	});
+	// Each thread owns its object, moved in and out of a call as the shared_ptr above: no count to
+	// update at all, nothing shared between the threads
+	scaling("unique_ptr move in/out, per thread", [](unsigned) {
+		std::unique_ptr<Object> owned = std::make_unique<Object>();
+		for (std::size_t i = 0; i < opsPerThread; ++i) {
+			owned = byValueMovedBack(std::move(owned));
+		}
+	});
+	scaling("raw pointer borrow", [&](unsigned) {
+		const Object* raw = shared.get();
+		for (std::size_t i = 0; i < opsPerThread; ++i) {
+			bench::doNotOptimize(borrow(raw));
+		}
+	});
+}
@@ -0,0 +1,58 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "bench.h"
+#include "../retentionTracker.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cost of the live-object tracking (see retentionTracker.h): construction + destruction of an
+// untracked object vs a tracked one, stacks sampled 1 out of 1024, 64, or never.
+// Then 1 to N threads: per-thread counters, no shared cache line.
+
+namespace {
+
+const std::size_t opsPerThread = 2000000;
+
+struct Plain {
+	long value = 1;
+};
+
+struct Tracked : private retention_tracked<Tracked> {
+	static constexpr const char* retention_name = "Tracked";
+	long value = 1;
+};
+
+template <class T>
+[[gnu::noinline]] long lifetime() {
+	T t;
+	bench::doNotOptimize(t);
+	return t.value;
+}
+
+} // namespace
+
+void retentionBench() {
+	const std::uint32_t previous = retention_sampling();
+
+	bench::run("retention/construct + destroy/untracked", [] { bench::doNotOptimize(lifetime<Plain>()); });
+	for (std::uint32_t every : {0u, 1024u, 64u}) {
+		retention_sampling(every);
+		const std::string sampling = every == 0 ? "no stack" : "stack 1/" + std::to_string(every);
+		bench::run("retention/construct + destroy/tracked, " + sampling, [] {
+			bench::doNotOptimize(lifetime<Tracked>());
+		});
+	}
+
+	retention_sampling(1024);
+	for (unsigned threads : bench::threadCounts()) {
+		bench::runThreads("retention/tracked, stack 1/1024", threads, opsPerThread, [](unsigned) {
+			retention_sampling(1024);
+			for (std::size_t i = 0; i < opsPerThread; ++i) {
+				bench::doNotOptimize(lifetime<Tracked>());
+			}
+		});
+	}
+
+	retention_sampling(previous);
+}
@@ -0,0 +1,57 @@
+#include <cstddef>
+#include <vector>
+
+#include "bench.h"
+#include "../instrumentedTypes.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// NRVO (rvo1a) vs no NRVO (rvo2a: two named candidates, the returned one is copied or moved)
+// RVO has no move constructor: without NRVO it is copied. std::vector<int> is moved instead.
+
+namespace {
+
+const std::size_t vectorSize = 1000;
+
+template <class T, class... Args>
+[[gnu::noinline]] T nrvo(const Args&... args) {
+	T value(args...);
+	return value; // NRVO: built in the caller's storage
+}
+
+template <class T, class... Args>
+[[gnu::noinline]] T noNrvo(bool cond, const Args&... args) {
+	T value1(args...);
+	T value2(args...);
+	if (cond) {
+		return value1; // Which one is returned is known at run time only: no NRVO
+	} else {
+		return value2;
+	}
+}
+
+template <class T, class... Args>
+[[gnu::noinline]] T rvo(bool cond, const Args&... args) {
+	if (cond) {
+		return T(args...); // rvo2b: prvalues, guaranteed elision
+	} else {
+		return T(args...);
+	}
+}
+
+} // namespace
+
+void rvoBench() {
+	bench::run("rvo/RVO/NRVO (rvo1a)", [] { RVO r = nrvo<RVO>(); bench::doNotOptimize(r); });
+	bench::run("rvo/RVO/no NRVO (rvo2a)", [] { RVO r = noNrvo<RVO>(true); bench::doNotOptimize(r); });
+	bench::run("rvo/RVO/RVO (rvo2b)", [] { RVO r = rvo<RVO>(true); bench::doNotOptimize(r); });
+
+	// noNrvo builds two vectors: the difference with nrvo is mostly the second one, not the move
+	bench::run("rvo/vector<int>(1000)/NRVO", [] {
+		std::vector<int> v = nrvo<std::vector<int>>(vectorSize);
+		bench::doNotOptimize(v.data());
+	});
+	bench::run("rvo/vector<int>(1000)/no NRVO", [] {
+		std::vector<int> v = noNrvo<std::vector<int>>(true, vectorSize);
+		bench::doNotOptimize(v.data());
+	});
+}
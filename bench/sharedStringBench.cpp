@@ -0,0 +1,62 @@
+#include <cstddef>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "../immutableString.h"
+#include "../sharedString.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Fan-out: one long string copied into many containers, rarely changed
+// string (deep copy: allocation + memcpy per copy) vs shared_string (shared buffer: one atomic
+// increment per copy) vs std::string (deep copy)
+// Then the append chain of stringAppendBench, where shared_string appends in place when unique.
+
+namespace {
+
+const std::size_t fanOut = 1000;
+const char* const longText = "a string too long to be stored inline, copied into many containers";
+
+template <class S>
+void copies(const S& s, std::vector<S>& containers) {
+	containers.clear();
+	for (std::size_t i = 0; i < fanOut; ++i) {
+		containers.push_back(s);
+	}
+	bench::doNotOptimize(containers.data());
+}
+
+template <class S>
+void benchFanOut(const std::string& type) {
+	const S s(longText);
+	std::vector<S> containers;
+	containers.reserve(fanOut); // Measure the copies only
+
+	const std::size_t startBytes = bench::allocatedBytes();
+	copies(s, containers);
+	const double bytes = double(bench::allocatedBytes() - startBytes) / fanOut;
+
+	if (bench::run("sharedString/fan-out x" + std::to_string(fanOut) + "/" + type, [&] { copies(s, containers); }) == 0) {
+		return; // Filtered out
+	}
+	bench::notes() << "    bytes/copy: " << std::fixed << std::setprecision(1) << bytes << std::endl;
+}
+
+template <class S>
+void appendChain() {
+	S s = S("a string already too long for the inline buffer").append("1...").append("2...").append("3...")
+	                                                    .append("4...").append("5...");
+	bench::doNotOptimize(s.c_str());
+}
+
+} // namespace
+
+void sharedStringBench() {
+	benchFanOut<string>("string");
+	benchFanOut<shared_string>("shared_string");
+	benchFanOut<std::string>("std::string");
+
+	bench::run("sharedString/append chain x5/string", appendChain<string>);
+	bench::run("sharedString/append chain x5/shared_string", appendChain<shared_string>);
+}
@@ -0,0 +1,129 @@
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench.h"
+#include "../slotMap.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Objects owned by a container, referenced by references that detect their death:
+// slot_map<T> + slot_handle (contiguous objects, 8-byte handles) vs
+// std::vector<std::shared_ptr<T>> + std::weak_ptr (one heap node per object, atomic counts)
+// at 10^5, 10^6 and 10^7 objects:
+// - iterate: sum over all the objects
+// - lookup: random reference -> object (weak_ptr::lock vs generation check)
+// - churn: erase a random object (swap and pop) and insert a new one
+
+namespace {
+
+struct Particle {
+	double x;
+	double v;
+};
+
+const std::size_t randomCount = std::size_t(1) << 20;
+
+// Reproducible random positions in [0, n)
+std::vector<std::uint32_t> randomPositions(std::size_t n) {
+	std::vector<std::uint32_t> positions(randomCount);
+	std::uint64_t x = 88172645463325252u;
+	for (std::uint32_t& p : positions) {
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+		p = std::uint32_t(x % n);
+	}
+	return positions;
+}
+
+void benchSlotMap(std::size_t n, const std::string& suffix, const std::vector<std::uint32_t>& random) {
+	slot_map<Particle> particles;
+	particles.reserve(n);
+	std::vector<slot_handle> handles;
+	handles.reserve(n);
+	for (std::size_t i = 0; i < n; ++i) {
+		handles.push_back(particles.insert({double(i), 1.0}));
+	}
+
+	bench::run("slotMap/iterate/" + suffix + "/slot_map", [&] {
+		double sum = 0;
+		for (const Particle& p : particles) {
+			sum += p.x;
+		}
+		bench::doNotOptimize(sum);
+	});
+
+	std::size_t i = 0;
+	bench::run("slotMap/lookup/" + suffix + "/slot_map", [&] {
+		const Particle* p = particles.get(handles[random[i++ % randomCount]]);
+		bench::doNotOptimize(p != nullptr ? p->x : 0.0);
+	});
+
+	bench::run("slotMap/churn/" + suffix + "/slot_map", [&] {
+		slot_handle& h = handles[random[i++ % randomCount]];
+		particles.erase(h);
+		h = particles.insert({double(i), 1.0});
+	});
+}
+
+void benchSharedPtr(std::size_t n, const std::string& suffix, const std::vector<std::uint32_t>& random) {
+	std::vector<std::shared_ptr<Particle>> owners;
+	owners.reserve(n);
+	std::vector<std::weak_ptr<Particle>> references;
+	references.reserve(n);
+	for (std::size_t i = 0; i < n; ++i) {
+		owners.push_back(std::make_shared<Particle>(Particle{double(i), 1.0}));
+		references.push_back(owners.back());
+	}
+
+	bench::run("slotMap/iterate/" + suffix + "/shared_ptr", [&] {
+		double sum = 0;
+		for (const std::shared_ptr<Particle>& p : owners) {
+			sum += p->x;
+		}
+		bench::doNotOptimize(sum);
+	});
+
+	std::size_t i = 0;
+	bench::run("slotMap/lookup/" + suffix + "/weak_ptr", [&] {
+		const std::shared_ptr<Particle> p = references[random[i++ % randomCount]].lock();
+		bench::doNotOptimize(p != nullptr ? p->x : 0.0);
+	});
+
+	// The object at a random position dies (its references expire), a new one takes a random reference
+	bench::run("slotMap/churn/" + suffix + "/shared_ptr", [&] {
+		const std::uint32_t position = random[i++ % randomCount];
+		owners[position] = std::move(owners.back());
+		owners.pop_back();
+		owners.push_back(std::make_shared<Particle>(Particle{double(i), 1.0}));
+		references[random[i++ % randomCount]] = owners.back();
+	});
+}
+
+bool anyEnabled(const std::string& suffix) {
+	for (const char* op : {"iterate", "lookup", "churn"}) {
+		for (const char* type : {"slot_map", "shared_ptr", "weak_ptr"}) {
+			if (bench::enabled(std::string("slotMap/") + op + "/" + suffix + "/" + type)) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+} // namespace
+
+void slotMapBench() {
+	for (std::size_t n : {std::size_t(100000), std::size_t(1000000), std::size_t(10000000)}) {
+		const std::string suffix = "1e" + std::to_string(std::to_string(n).size() - 1);
+		if (!anyEnabled(suffix)) {
+			continue; // Filtered out: do not build 10^7 objects for nothing
+		}
+		const std::vector<std::uint32_t> random = randomPositions(n);
+		benchSlotMap(n, suffix, random);
+		benchSharedPtr(n, suffix, random);
+	}
+}
@@ -0,0 +1,98 @@
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#include "bench.h"
+#include "eagerString.h"
+#include "../immutableString.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// string("s").append("1...").append("2...")... with 2, 8 and 64 pieces (head included), and the
+// variants of moveSemanticsThis() (lvalue or rvalue head, assignment, returned)
+
+namespace {
+
+const char* const piece = "1...";
+
+// Eager baseline: each link reallocates and copies the whole buffer, O(n^2) bytes copied
+template <std::size_t Pieces>
+void eagerChain() {
+	eager_string s("s");
+	for (std::size_t i = 1; i < Pieces; ++i) {
+		std::move(s).append(piece);
+	}
+	bench::doNotOptimize(s.c_str());
+}
+
+// Lazy chain: the links only record pieces, the buffer is built once by the conversion to string
+// (the links of the chain live in the frames of the recursion until the conversion)
+template <std::size_t Remaining>
+string lazyAppend(string_concat&& chain) {
+	if constexpr (Remaining == 0) {
+		return std::move(chain);
+	} else {
+		return lazyAppend<Remaining - 1>(std::move(chain).append(piece));
+	}
+}
+
+template <std::size_t Pieces>
+void lazyChain() {
+	string s = lazyAppend<Pieces - 2>(string("s").append(piece));
+	bench::doNotOptimize(s.c_str());
+}
+
+template <std::size_t Pieces>
+void stdStringChain() {
+	std::string s("s");
+	for (std::size_t i = 1; i < Pieces; ++i) {
+		s.append(piece);
+	}
+	bench::doNotOptimize(s.data());
+}
+
+template <std::size_t Pieces>
+void benchChain() {
+	std::string suffix = "<" + std::to_string(Pieces) + ">";
+	bench::run("stringAppend/eager" + suffix, eagerChain<Pieces>);
+	bench::run("stringAppend/lazy" + suffix, lazyChain<Pieces>);
+	bench::run("stringAppend/std::string" + suffix, stdStringChain<Pieces>);
+}
+
+[[gnu::noinline]] string returned() {
+	return string("s").append("1...").append("2...");
+}
+
+// The variants of moveSemanticsThis()
+void benchVariants() {
+	const string a("a");
+	bench::run("stringAppend/variant b: a.append()", [&] {
+		string b = a.append("...");
+		bench::doNotOptimize(b.c_str());
+	});
+	bench::run("stringAppend/variant c: a.append().append()", [&] {
+		string c = a.append("1...").append("2...");
+		bench::doNotOptimize(c.c_str());
+	});
+	bench::run("stringAppend/variant d: string().append().append()", [] {
+		string d = string("s").append("1...").append("2...");
+		bench::doNotOptimize(d.c_str());
+	});
+	string e("e");
+	bench::run("stringAppend/variant e: e = string().append().append()", [&] {
+		e = string("s").append("1...").append("2...");
+		bench::doNotOptimize(e.c_str());
+	});
+	bench::run("stringAppend/variant f: returned", [] {
+		string f = returned();
+		bench::doNotOptimize(f.c_str());
+	});
+}
+
+} // namespace
+
+void stringAppendBench() {
+	benchChain<2>();
+	benchChain<8>();
+	benchChain<64>();
+	benchVariants();
+}
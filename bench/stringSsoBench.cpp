@@ -0,0 +1,76 @@
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench.h"
+#include "eagerString.h"
+#include "../immutableString.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Small string optimization: construction, copy and move of short and long strings
+// eager_string (char* only, strlen on each operation) vs string (inline up to 23 chars) vs std::string
+
+namespace {
+
+const char* const oneChar = "a";
+const char* const identifier = "request_id_42";
+const char* const longText = "a string too long to be stored inline by any of them";
+
+template <class S>
+void construct(const char* p) {
+	S s(p);
+	bench::doNotOptimize(s.c_str());
+}
+
+template <class S>
+void copy(const S& s) {
+	S c(s);
+	bench::doNotOptimize(c.c_str());
+}
+
+template <class S>
+void move(const char* p) {
+	S s(p);
+	S m(std::move(s));
+	bench::doNotOptimize(m.c_str());
+}
+
+// Most strings of the workload are short identifiers
+template <class S>
+void identifiers() {
+	static const char* const names[] = {"id", "name", "value", "x", "y", "request_id_42", "a", "b",
+	                                    "timestamp", "user"};
+	std::vector<S> v;
+	v.reserve(100);
+	for (int i = 0; i < 10; ++i) {
+		for (const char* n : names) {
+			v.emplace_back(n);
+		}
+	}
+	bench::doNotOptimize(v.data());
+}
+
+template <class S>
+void benchString(const std::string& type) {
+	bench::run("stringSso/construct/1/" + type, [] { construct<S>(oneChar); });
+	bench::run("stringSso/construct/13/" + type, [] { construct<S>(identifier); });
+	bench::run("stringSso/construct/52/" + type, [] { construct<S>(longText); });
+
+	S shortString(identifier);
+	S longString(longText);
+	bench::run("stringSso/copy/13/" + type, [&] { copy(shortString); });
+	bench::run("stringSso/copy/52/" + type, [&] { copy(longString); });
+
+	bench::run("stringSso/move/13/" + type, [] { move<S>(identifier); });
+	bench::run("stringSso/move/52/" + type, [] { move<S>(longText); });
+
+	bench::run("stringSso/identifiers x100/" + type, identifiers<S>);
+}
+
+} // namespace
+
+void stringSsoBench() {
+	benchString<eager_string>("eager_string");
+	benchString<string>("string");
+	benchString<std::string>("std::string");
+}
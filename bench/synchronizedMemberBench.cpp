@@ -0,0 +1,81 @@
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+#include "bench.h"
+#include "../synchronizedMember.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// One object read and written by 1 to 64 threads (90% and 50% of reads):
+// A of mutableConst.cpp (a mutex per object) vs synchronized_member strategies
+
+namespace {
+
+const std::size_t opsPerThread = 200000;
+
+// A of mutableConst.cpp, with a getter
+class MutexA {
+public:
+	mutable int a = 0;
+	mutable std::mutex m;
+
+	void f() const {
+		std::lock_guard<std::mutex> lk(m);
+		a = 2;
+	}
+
+	int get() const {
+		std::lock_guard<std::mutex> lk(m);
+		return a;
+	}
+};
+
+struct Point {
+	long x = 0;
+	long y = 0;
+};
+
+// Operation i of a thread is a read when i % 10 < readsOutOf10
+template <class Read, class Write>
+void mix(unsigned thread, unsigned readsOutOf10, Read read, Write write) {
+	for (std::size_t i = 0; i < opsPerThread; ++i) {
+		if ((i + thread) % 10 < readsOutOf10) {
+			read();
+		} else {
+			write(long(i));
+		}
+	}
+}
+
+template <sync_strategy Strategy>
+void benchPoint(const std::string& name, unsigned threads, unsigned readsOutOf10, const std::string& suffix) {
+	synchronized_member<Point, Strategy> point;
+	bench::runThreads("synchronizedMember/" + name + suffix, threads, opsPerThread, [&](unsigned t) {
+		mix(t, readsOutOf10, [&] { bench::doNotOptimize(point.load()); },
+		    [&](long i) { point.store({i, -i}); });
+	});
+}
+
+void benchMix(unsigned readsOutOf10) {
+	const std::string suffix = "/" + std::to_string(readsOutOf10 * 10) + "% reads";
+	for (unsigned threads : bench::threadCounts(64)) {
+		MutexA mutexA;
+		bench::runThreads("synchronizedMember/int: mutex per object (A)" + suffix, threads, opsPerThread,
+		                  [&](unsigned t) {
+			mix(t, readsOutOf10, [&] { bench::doNotOptimize(mutexA.get()); }, [&](long) { mutexA.f(); });
+		});
+		synchronized_member<int> a;
+		bench::runThreads("synchronizedMember/int: atomic" + suffix, threads, opsPerThread, [&](unsigned t) {
+			mix(t, readsOutOf10, [&] { bench::doNotOptimize(a.load()); }, [&](long) { a.store(2); });
+		});
+		benchPoint<sync_strategy::mutex>("Point: mutex", threads, readsOutOf10, suffix);
+		benchPoint<sync_strategy::seqlock>("Point: seqlock", threads, readsOutOf10, suffix);
+	}
+}
+
+} // namespace
+
+void synchronizedMemberBench() {
+	benchMix(9);
+	benchMix(5);
+}
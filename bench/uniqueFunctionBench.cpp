@@ -0,0 +1,81 @@
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+
+#include "bench.h"
+#include "../instrumentedTypes.h"
+#include "../uniqueFunction.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// std::function vs unique_function (32 bytes inline) holding a mutable lambda of 0 to 128 bytes
+// - construction: from the lambda, allocation when not inline (std::function: up to 16 bytes, and
+//   trivially copyable only)
+// - move round trip: move construction + move assignment back
+// - invoke: one call through the wrapper
+// - a move-only capture (B): unique_function only, std::function requires copyable callables.
+//   The move constructor of B is not noexcept: the lambda is on the heap (2 allocations with B's int)
+
+namespace {
+
+template <std::size_t Bytes>
+struct payload {
+	long values[Bytes / sizeof(long)] = {1};
+};
+
+// A mutable lambda whose captures take 'Bytes' bytes
+template <std::size_t Bytes>
+auto makeCallable() {
+	if constexpr (Bytes == 0) {
+		return [](long x) { return x + 1; };
+	} else {
+		return [p = payload<Bytes>()](long x) mutable { return p.values[0] += x; };
+	}
+}
+
+template <class Function, std::size_t Bytes>
+void benchFunction(const std::string& name) {
+	const std::string suffix = "/" + std::to_string(Bytes) + " bytes/" + name;
+
+	bench::run("uniqueFunction/construction" + suffix, [] {
+		Function f = makeCallable<Bytes>();
+		bench::doNotOptimize(f);
+	});
+
+	Function f1 = makeCallable<Bytes>();
+	bench::run("uniqueFunction/move round trip" + suffix, [&] {
+		Function f2(std::move(f1));
+		bench::doNotOptimize(f2);
+		f1 = std::move(f2);
+	});
+
+	long x = 1;
+	bench::run("uniqueFunction/invoke" + suffix, [&] {
+		bench::doNotOptimize(x);
+		bench::doNotOptimize(f1(x));
+	});
+}
+
+template <std::size_t Bytes>
+void benchBoth() {
+	static_assert(sizeof(makeCallable<Bytes>()) == (Bytes == 0 ? 1 : Bytes));
+	benchFunction<std::function<long(long)>, Bytes>("std::function");
+	benchFunction<unique_function<long(long)>, Bytes>("unique_function");
+}
+
+} // namespace
+
+void uniqueFunctionBench() {
+	benchBoth<0>();
+	benchBoth<8>();
+	benchBoth<16>();
+	benchBoth<32>();
+	benchBoth<64>();
+	benchBoth<128>();
+
+	// Move-only capture: the lambda holds a B (heap int), moved into the wrapper
+	bench::run("uniqueFunction/construction/move-only B/unique_function", [] {
+		unique_function<int()> f = [b = B(5)]() mutable { return ++*b.b; };
+		bench::doNotOptimize(f);
+	});
+}
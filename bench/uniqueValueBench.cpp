@@ -0,0 +1,79 @@
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench.h"
+#include "../instrumentedTypes.h"
+#include "../uniqueValue.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Move-only owners of an int: B (heap int), std::unique_ptr<int>, unique_value<int> (inline int)
+// - construction: allocation or not
+// - move round trip: move construction + move assignment back (pointer vs int, same null state)
+// - access: sum of the ints of 1000 owners (indirection or not)
+
+namespace {
+
+const std::size_t ownerCount = 1000;
+
+// Construction and access, the same for the three owners
+template <class Owner>
+struct owner_traits;
+
+template <>
+struct owner_traits<B> {
+	static B make(int i) { return B(i); }
+	static int value(const B& b) { return *b.b; }
+};
+
+template <>
+struct owner_traits<std::unique_ptr<int>> {
+	static std::unique_ptr<int> make(int i) { return std::make_unique<int>(i); }
+	static int value(const std::unique_ptr<int>& p) { return *p; }
+};
+
+template <>
+struct owner_traits<unique_value<int>> {
+	static unique_value<int> make(int i) { return make_unique_value<int>(i); }
+	static int value(const unique_value<int>& v) { return *v; }
+};
+
+template <class Owner>
+void benchOwner(const std::string& name) {
+	using traits = owner_traits<Owner>;
+
+	bench::run("uniqueValue/construction/" + name, [] {
+		Owner o = traits::make(5);
+		bench::doNotOptimize(traits::value(o));
+	});
+
+	Owner o1 = traits::make(5);
+	bench::run("uniqueValue/move round trip/" + name, [&] {
+		Owner o2(std::move(o1));
+		bench::doNotOptimize(traits::value(o2));
+		o1 = std::move(o2);
+	});
+
+	std::vector<Owner> owners;
+	owners.reserve(ownerCount);
+	for (std::size_t i = 0; i < ownerCount; ++i) {
+		owners.push_back(traits::make(int(i)));
+	}
+	bench::run("uniqueValue/access x" + std::to_string(ownerCount) + "/" + name, [&] {
+		long sum = 0;
+		for (const Owner& o : owners) {
+			sum += traits::value(o);
+		}
+		bench::doNotOptimize(sum);
+	});
+}
+
+} // namespace
+
+void uniqueValueBench() {
+	benchOwner<B>("B");
+	benchOwner<std::unique_ptr<int>>("unique_ptr<int>");
+	benchOwner<unique_value<int>>("unique_value<int>");
+}
@@ -0,0 +1,153 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bench.h"
+#include "../uniqueFunction.h"
+#include "../workStealingPool.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Fine-grained tasks (empty, 250 ns, 1 us) run by 1 to N threads, by batches of 1000
+// - work stealing post: the batch submitted from outside the pool (inboxes), waited for
+// - work stealing parallel_for: chunks of one task, the calling thread helps (N + 1 threads)
+// - mutex+condvar: the classic pool, one queue under one lock
+// - std::async: a thread per task (independent of N)
+// The time is the one of a batch; "speedup" compares N threads with 1.
+
+namespace {
+
+const std::size_t batch = 1000;
+
+void work(long ns) {
+	if (ns == 0) {
+		return;
+	}
+	const auto end = std::chrono::steady_clock::now() + std::chrono::nanoseconds(ns);
+	while (std::chrono::steady_clock::now() < end) {
+	}
+}
+
+// One queue, one lock, one condition variable
+class locked_queue_pool {
+	std::mutex lock;
+	std::condition_variable available;
+	std::deque<unique_function<void()>> tasks;
+	bool stopping = false;
+	std::vector<std::thread> threads;
+
+public:
+	explicit locked_queue_pool(unsigned count) {
+		for (unsigned t = 0; t < count; ++t) {
+			threads.emplace_back([this] {
+				for (;;) {
+					std::unique_lock<std::mutex> l(lock);
+					available.wait(l, [this] { return stopping || !tasks.empty(); });
+					if (tasks.empty()) {
+						return;
+					}
+					unique_function<void()> task = std::move(tasks.front());
+					tasks.pop_front();
+					l.unlock();
+					task();
+				}
+			});
+		}
+	}
+
+	~locked_queue_pool() {
+		{
+			std::lock_guard<std::mutex> l(lock);
+			stopping = true;
+		}
+		available.notify_all();
+		for (std::thread& t : threads) {
+			t.join();
+		}
+	}
+
+	template <class F>
+	void post(F&& f) {
+		{
+			std::lock_guard<std::mutex> l(lock);
+			tasks.emplace_back(std::forward<F>(f));
+		}
+		available.notify_one();
+	}
+};
+
+// Post a batch of tasks, wait until they are all done
+template <class Pool>
+void postBatch(Pool& pool, long ns) {
+	std::atomic<std::size_t> remaining{batch};
+	for (std::size_t i = 0; i < batch; ++i) {
+		pool.post([&remaining, ns] {
+			work(ns);
+			remaining.fetch_sub(1, std::memory_order_release);
+		});
+	}
+	while (remaining.load(std::memory_order_acquire) != 0) {
+		std::this_thread::yield();
+	}
+}
+
+std::string taskName(long ns) {
+	return ns == 0 ? "empty" : std::to_string(ns) + " ns";
+}
+
+// batchOf(threads) runs a batch on a pool of 'threads': on 1 to N threads, with the speedups
+template <class BatchOf>
+void scaling(const std::string& name, long ns, BatchOf batchOf) {
+	double single = 0;
+	for (unsigned threads : bench::threadCounts()) {
+		const std::string fullName = "pool/x" + std::to_string(batch) + " " + taskName(ns) + " tasks/" + name
+		                             + " x" + std::to_string(threads);
+		if (!bench::enabled(fullName)) {
+			continue;
+		}
+		const double batchNs = batchOf(fullName, threads);
+		if (threads == 1) {
+			single = batchNs;
+		} else if (single != 0 && batchNs != 0) {
+			bench::notes() << "    speedup: " << std::fixed << std::setprecision(2) << single / batchNs << std::endl;
+		}
+	}
+}
+
+} // namespace
+
+void workStealingPoolBench() {
+	for (long ns : {0L, 250L, 1000L}) {
+		scaling("work stealing post", ns, [ns](const std::string& name, unsigned threads) {
+			work_stealing_pool pool(threads);
+			return bench::run(name, [&] { postBatch(pool, ns); });
+		});
+		scaling("work stealing parallel_for", ns, [ns](const std::string& name, unsigned threads) {
+			work_stealing_pool pool(threads);
+			return bench::run(name, [&] { pool.parallel_for(0, batch, [ns](std::size_t) { work(ns); }, 1); });
+		});
+		scaling("mutex+condvar post", ns, [ns](const std::string& name, unsigned threads) {
+			locked_queue_pool pool(threads);
+			return bench::run(name, [&] { postBatch(pool, ns); });
+		});
+		bench::run("pool/x" + std::to_string(batch) + " " + taskName(ns) + " tasks/std::async", [ns] {
+			std::vector<std::future<void>> futures;
+			futures.reserve(batch);
+			for (std::size_t i = 0; i < batch; ++i) {
+				futures.push_back(std::async(std::launch::async, [ns] { work(ns); }));
+			}
+			for (std::future<void>& f : futures) {
+				f.get();
+			}
+		});
+	}
+}
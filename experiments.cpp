@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "allocationAudit.h"
+#include "experiments.h"
+#include "workStealingPool.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Registry
+
+namespace {
+
+struct Registered {
+	std::string name;            // "group/name"
+	std::string group;
+	experiment e;
+	std::size_t order;           // Of registration
+};
+
+// Never destroyed: filled by static initializers of any translation unit
+std::vector<Registered>& registry() {
+	static std::vector<Registered>* const r = new std::vector<Registered>;
+	return *r;
+}
+
+} // namespace
+
+experiment_group::experiment_group(const char* group, std::initializer_list<experiment> experiments) {
+	for (const experiment& e : experiments) {
+		registry().push_back({std::string(group) + "/" + e.name, group, e, registry().size()});
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Options
+
+namespace {
+
+struct Options {
+	std::vector<std::string> filters;   // Globs (* and ?) or substrings, any of them
+	std::size_t repeat = 1;
+	unsigned jobs = 1;
+	bool time = false;
+	bool audit = false;
+	bool quiet = false;
+	bool list = false;
+};
+
+void usage(const char* program) {
+	std::cerr << "usage: " << program << " [--filter=PATTERN[,PATTERN...]] [--repeat=N] [--jobs=N] [--time]"
+	          << " [--audit] [--quiet] [--list]" << std::endl
+	          << "  --filter  experiments whose name (group/name) matches a glob (* ?), or contains it" << std::endl
+	          << "  --repeat  run the selection N times (output of the first run only)" << std::endl
+	          << "  --jobs    run the parallel experiments on N threads (0: one per core)" << std::endl
+	          << "  --time    print the time of each experiment (median and min of the runs)" << std::endl
+	          << "  --audit   print the heap allocations of each experiment (first run)" << std::endl
+	          << "  --quiet   do not print the output of the experiments" << std::endl
+	          << "  --list    print the names of the selected experiments, run nothing" << std::endl;
+}
+
+bool startsWith(const std::string& s, const char* prefix, std::string& value) {
+	const std::string p(prefix);
+	if (s.compare(0, p.size(), p) != 0) {
+		return false;
+	}
+	value = s.substr(p.size());
+	return true;
+}
+
+// Decimal digits only: "abc", "-3" or "2x" are invalid
+bool parseCount(const std::string& value, std::size_t& count) {
+	const char* end = value.data() + value.size();
+	std::from_chars_result r = std::from_chars(value.data(), end, count);
+	return !value.empty() && r.ec == std::errc() && r.ptr == end;
+}
+
+bool parse(int argc, char* argv[], Options& options) {
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		std::string value;
+		if (startsWith(arg, "--filter=", value)) {
+			std::istringstream patterns(value);
+			for (std::string pattern; std::getline(patterns, pattern, ',');) {
+				options.filters.push_back(pattern);
+			}
+		} else if (startsWith(arg, "--repeat=", value)) {
+			if (!parseCount(value, options.repeat) || options.repeat == 0) {
+				return false;
+			}
+		} else if (startsWith(arg, "--jobs=", value)) {
+			std::size_t jobs = 0;
+			if (!parseCount(value, jobs) || jobs > std::numeric_limits<unsigned>::max()) {
+				return false;
+			}
+			options.jobs = jobs != 0 ? unsigned(jobs) : std::max(1u, std::thread::hardware_concurrency());
+		} else if (arg == "--time") {
+			options.time = true;
+		} else if (arg == "--audit") {
+			options.audit = true;
+		} else if (arg == "--quiet") {
+			options.quiet = true;
+		} else if (arg == "--list") {
+			options.list = true;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool globMatch(const char* pattern, const char* s) {
+	for (; *pattern != '\0'; ++pattern, ++s) {
+		if (*pattern == '*') {
+			for (const char* rest = s;; ++rest) {
+				if (globMatch(pattern + 1, rest)) {
+					return true;
+				}
+				if (*rest == '\0') {
+					return false;
+				}
+			}
+		}
+		if (*s == '\0' || (*pattern != '?' && *pattern != *s)) {
+			return false;
+		}
+	}
+	return *s == '\0';
+}
+
+bool selected(const Options& options, const std::string& name) {
+	if (options.filters.empty()) {
+		return true;
+	}
+	for (const std::string& filter : options.filters) {
+		const bool glob = filter.find_first_of("*?") != std::string::npos;
+		if (glob ? globMatch(filter.c_str(), name.c_str()) : name.find(filter) != std::string::npos) {
+			return true;
+		}
+	}
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Output of each experiment
+
+// Installed in std::cout while the experiments run: writes to the buffer of the experiment running
+// in the calling thread (the experiments write to std::cout from any thread)
+class ThreadOutput : public std::streambuf {
+	std::streambuf* fallback;
+
+	std::streambuf* target() const { return current != nullptr ? current : fallback; }
+
+public:
+	static thread_local std::streambuf* current;
+
+	explicit ThreadOutput(std::streambuf* fallback) : fallback(fallback) {}
+
+protected:
+	int_type overflow(int_type c) override {
+		return traits_type::eq_int_type(c, traits_type::eof()) ? traits_type::not_eof(c) : target()->sputc(char(c));
+	}
+
+	std::streamsize xsputn(const char* s, std::streamsize n) override {
+		return target()->sputn(s, n);
+	}
+
+	int sync() override {
+		return target()->pubsync();
+	}
+};
+
+thread_local std::streambuf* ThreadOutput::current = nullptr;
+
+// Text written by an experiment. Reserved before the experiment runs: its output does not count in
+// its allocations (up to 'reserved' chars).
+class CapturedOutput : public std::streambuf {
+public:
+	static constexpr std::size_t reserved = 64 * 1024;
+
+	std::string text;
+
+	CapturedOutput() { text.reserve(reserved); }
+
+protected:
+	int_type overflow(int_type c) override {
+		if (!traits_type::eq_int_type(c, traits_type::eof())) {
+			text.push_back(char(c));
+		}
+		return traits_type::not_eof(c);
+	}
+
+	std::streamsize xsputn(const char* s, std::streamsize n) override {
+		text.append(s, std::size_t(n));
+		return n;
+	}
+};
+
+struct Run {
+	const Registered* r;
+	CapturedOutput output;               // Of the first run
+	std::vector<double> ms;
+	allocation_stats allocations;        // Of the first run
+	std::string error;                   // What the experiment threw
+};
+
+void runOnce(Run& run, bool first) {
+	CapturedOutput discarded;
+	ThreadOutput::current = first ? &run.output : &discarded;
+	double ms = 0;
+	{
+		allocation_scope scope;
+		const auto start = std::chrono::steady_clock::now();
+		try {
+			run.r->e.run();
+		} catch (const std::exception& e) {
+			run.error = e.what();
+		} catch (...) {
+			run.error = "unknown exception";
+		}
+		ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (first) {
+			run.allocations = scope.stats();
+		}
+	}
+	run.ms.push_back(ms);
+	ThreadOutput::current = nullptr;
+}
+
+// The serial experiments alone, then the parallel ones on the pool (and the calling thread)
+void runAll(std::vector<Run>& runs, work_stealing_pool& pool, bool first) {
+	std::vector<Run*> parallel;
+	for (Run& run : runs) {
+		if (run.r->e.runMode == experiment::serial) {
+			runOnce(run, first);
+		} else {
+			parallel.push_back(&run);
+		}
+	}
+	pool.parallel_for(0, parallel.size(), [&](std::size_t i) { runOnce(*parallel[i], first); }, 1);
+}
+
+void printTimes(std::ostream& os, const std::vector<Run>& runs) {
+	std::size_t width = 10;
+	for (const Run& run : runs) {
+		width = std::max(width, run.r->name.size());
+	}
+	os << std::left << std::setw(int(width)) << "experiment" << std::right << std::setw(6) << "runs"
+	   << std::setw(12) << "median ms" << std::setw(12) << "min ms" << std::endl;
+	for (const Run& run : runs) {
+		std::vector<double> sorted = run.ms;
+		std::sort(sorted.begin(), sorted.end());
+		os << std::left << std::setw(int(width)) << run.r->name << std::right << std::setw(6) << sorted.size()
+		   << std::fixed << std::setprecision(3) << std::setw(12) << sorted[sorted.size() / 2]
+		   << std::setw(12) << sorted.front() << std::endl;
+	}
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Runner
+
+int run_experiments(int argc, char* argv[]) {
+	Options options;
+	if (!parse(argc, argv, options)) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::vector<const Registered*> order;
+	for (const Registered& r : registry()) {
+		if (selected(options, r.name)) {
+			order.push_back(&r);
+		}
+	}
+	std::sort(order.begin(), order.end(), [](const Registered* a, const Registered* b) {
+		return a->group != b->group ? a->group < b->group : a->order < b->order;
+	});
+	if (options.list) {
+		for (const Registered* r : order) {
+			std::cout << r->name << (r->e.runMode == experiment::serial ? " (serial)" : "") << std::endl;
+		}
+		return EXIT_SUCCESS;
+	}
+
+	std::vector<Run> runs(order.size());
+	for (std::size_t i = 0; i < order.size(); ++i) {
+		runs[i].r = order[i];
+	}
+	std::streambuf* const standardOutput = std::cout.rdbuf();
+	ThreadOutput threadOutput(standardOutput);
+	std::cout.rdbuf(&threadOutput);
+	{
+		work_stealing_pool pool(options.jobs - 1); // The calling thread is the last job
+		for (std::size_t rep = 0; rep < options.repeat; ++rep) {
+			runAll(runs, pool, rep == 0);
+		}
+	}
+	std::cout.rdbuf(standardOutput);
+
+	int status = EXIT_SUCCESS;
+	allocation_table audit;
+	for (Run& run : runs) {
+		if (!options.quiet) {
+			std::cout << run.output.text << std::flush;
+		}
+		if (!run.error.empty()) {
+			std::cerr << "FAILED " << run.r->name << ": " << run.error << std::endl;
+			status = EXIT_FAILURE;
+		}
+		audit.add(run.r->name, run.allocations);
+	}
+	if (options.audit) {
+		std::cout << "Heap allocations" << std::endl;
+		audit.print(std::cout);
+	}
+	if (options.time) {
+		std::cout << "Times" << std::endl;
+		printTimes(std::cout, runs);
+	}
+	return status;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Registry of the experiments and their runner (main of CppExperiments)
+//
+// Each file registers its experiments, in the order they are run, at static initialization:
+//
+// static const experiment_group instantiation("instantiation", {
+//     {"uniquePtr", uniquePtr},
+//     {"retainedObjects", retainedObjects, experiment::serial},
+// });
+//
+// The full name of an experiment is "group/name" (e.g. "instantiation/testCopy"). The groups are
+// run in the order of their names, the experiments of a group in their order of registration.
+// The output of each experiment (std::cout) is buffered and written at once, in that order, also
+// when the experiments run concurrently (--jobs).
+// An experiment using a global state (other than the thread-local counters: lifecycleCounters.h,
+// allocationAudit.h) is 'serial': it never runs concurrently with another one.
+
+struct experiment {
+	enum mode { parallel, serial };
+
+	const char* name;
+	void (*run)();
+	mode runMode = parallel;
+};
+
+class experiment_group {
+public:
+	experiment_group(const char* group, std::initializer_list<experiment> experiments);
+};
+
+// Command line: see the usage (--help). Return the exit status: failure when an experiment throws.
+int run_experiments(int argc, char* argv[]);
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+
+#include "immutableString.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Compile-time string of fixed capacity
+//
+// The literal chains of moveSemanticsThis() built in constant expressions: the result is a constant
+// in .rodata, no allocation nor copy at run time.
+//
+// constexpr auto s = fixed_string("s").append("1...").append("2..."); // fixed_string<9>
+// static_assert(s == "s1...2...");
+// string r = s.borrow(); // no copy when s has static storage duration (constexpr variable)
+//
+// The capacity is part of the type: append() returns a fixed_string large enough for both sides.
+
+template <std::size_t N>
+class fixed_string {
+	char chars[N + 1] = {};
+	std::size_t length = 0;
+
+	template <std::size_t M>
+	friend class fixed_string;
+
+public:
+	constexpr fixed_string() = default;
+
+	// From a literal: fixed_string("abc") is a fixed_string<3>
+	constexpr fixed_string(const char (&p)[N + 1]) {
+		while (length < N && p[length] != '\0') {
+			chars[length] = p[length];
+			++length;
+		}
+	}
+
+	template <std::size_t M>
+	constexpr fixed_string<N + M - 1> append(const char (&p)[M]) const {
+		return append(fixed_string<M - 1>(p));
+	}
+
+	template <std::size_t M>
+	constexpr fixed_string<N + M> append(const fixed_string<M>& other) const {
+		fixed_string<N + M> result;
+		for (std::size_t i = 0; i < length; ++i) {
+			result.chars[result.length++] = chars[i];
+		}
+		for (std::size_t i = 0; i < other.length; ++i) {
+			result.chars[result.length++] = other.chars[i];
+		}
+		return result;
+	}
+
+	constexpr const char* c_str() const { return chars; }
+	constexpr std::size_t size() const { return length; }
+	static constexpr std::size_t capacity() { return N; }
+
+	constexpr char operator[](std::size_t i) const { return chars[i]; }
+
+	template <std::size_t M>
+	constexpr bool operator==(const char (&p)[M]) const {
+		if (length != M - 1) {
+			return false;
+		}
+		for (std::size_t i = 0; i < length; ++i) {
+			if (chars[i] != p[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template <std::size_t M>
+	constexpr bool operator!=(const char (&p)[M]) const {
+		return !(*this == p);
+	}
+
+	// Runtime string copied from the chars (inline up to string::small_capacity, no strlen)
+	string str() const {
+		return string(chars, length);
+	}
+
+	// Runtime string referencing the chars when too long to be inline: never allocates.
+	// *this shall outlive the result (e.g. a constexpr or static variable).
+	string borrow() const {
+		return string::borrow(chars, length);
+	}
+};
+
+template <std::size_t M>
+fixed_string(const char (&)[M]) -> fixed_string<M - 1>;
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <utility>
+
+#include "lifecycleCounters.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Immutable string with move semantics on "this" (rvalue reference for *this)
+//
+// Length and capacity are stored: no strlen on the string's own buffer. Strings up to
+// small_capacity chars are stored inline (small string optimization): no heap allocation.
+//
+// append() does not build a new buffer: it returns a string_concat expression that only records
+// the pieces of the chain. The buffer is allocated once, sized to the total length, when the
+// expression is converted to string:
+//     string("s").append("1...").append("2...") => at most 1 allocation, each byte copied once
+//
+// A string can also borrow a buffer of static storage duration (string::borrow, e.g. a literal or
+// a constexpr fixed_string, see fixedString.h): neither allocated, copied nor freed.
+//
+// Copies and moves are counted as "string" (see lifecycleCounters.h), their text is written under
+// a lifecycle_text_reporter only.
+
+class string_concat;
+class string_concat_head;
+
+class string {
+public:
+
+    // Longest string stored inline, without heap allocation (terminating null char excluded)
+    static constexpr size_t small_capacity = 23;
+
+private:
+
+    friend class string_concat;
+    friend class string_concat_head;
+
+    struct heap_buffer {
+        char *ptr;
+        size_t capacity;           // 0: borrowed buffer (read only, not freed)
+    };
+
+    // Active member: 'local' when length <= small_capacity, 'heap' otherwise (owned or borrowed)
+    union storage {
+        heap_buffer heap;
+        char local[small_capacity + 1];
+    };
+
+    size_t length;
+    storage buf;
+
+public:
+
+    static constexpr const char *lifecycle_name = "string";
+
+    string(const char *p) {
+        const size_t size = std::strlen(p);
+        std::memcpy(init(size), p, size);
+        lifecycle_record<string>(lifecycle_event::construction);
+    }
+
+    // 'size' chars of p, no strlen
+    string(const char *p, size_t size) {
+        std::memcpy(init(size), p, size);
+        lifecycle_record<string>(lifecycle_event::construction);
+    }
+
+    // Never allocates: a short string is copied inline, a longer one references 'p', which shall
+    // be null terminated and outlive the string and its copies (static storage duration)
+    static string borrow(const char *p, size_t size) {
+        string s;
+        if (size <= small_capacity) {
+            std::memcpy(s.init(size), p, size);
+        } else {
+            s.length = size;
+            s.buf.heap = {const_cast<char *>(p), 0};
+        }
+        return s;
+    }
+
+    ~string() {
+        lifecycle_record<string>(lifecycle_event::destruction);
+        if (!is_small() && !is_borrowed()) {
+            delete[] buf.heap.ptr;
+        }
+    }
+
+    // A borrowed buffer is shared, not copied
+    string(const string &that) {
+        lifecycle_record<string>(lifecycle_event::copy, [](std::ostream &os) { os << "constructor copy" << std::endl; });
+        if (that.is_borrowed()) {
+            length = that.length;
+            buf = that.buf;
+        } else {
+            std::memcpy(init(that.length), that.c_str(), that.length);
+        }
+    }
+
+    // O(1): the representation is copied, 'that' is left empty
+    string(string &&that) noexcept : length(that.length), buf(that.buf) {
+        lifecycle_record<string>(lifecycle_event::move, [](std::ostream &os) { os << "constructor move" << std::endl; });
+        that.reset();
+    }
+
+    // Delete operator= for immutablility: "a = b;" forbidden
+    string& operator=(const string& that) = delete;
+
+    // This operator lets the object immutable but it is weird and should not be defined:
+    // a = b;
+    // let 'a' untouched but the expression return a copy of 'b'
+//    string operator=(const string& that) const {
+//        cout << "= copy" << endl;
+//        return string(that);
+//    }
+
+    // string& operator=(string&& that) = delete;
+    //
+    // The object is no longer immutable (keep for the demo), operator= shall be deleted as above
+    //
+    string& operator=(string&& that) noexcept {
+        lifecycle_record<string>(lifecycle_event::move_assignment, [](std::ostream &os) { os << "= move" << std::endl; });
+        std::swap(length, that.length);
+        std::swap(buf, that.buf);
+        return *this;
+    }
+
+    // Could NOT be implemented alone, shall come with: append(const char *p) [const] &;
+    // Incompatible with: append(const char *p);
+    // The expression takes over the temporary (no copy, 'this' is left empty)
+    string_concat_head append(const char *p) &&;
+
+    // Could be implemented alone
+    // Incompatible with: append(const char *p);
+    // The expression only references 'this': it shall be converted before 'this' is destroyed
+    string_concat_head append(const char *p) const &;
+
+    const char* c_str() const {
+        return is_small() ? buf.local : buf.heap.ptr;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    // Chars that could be written without allocation (none in a borrowed buffer)
+    size_t capacity() const {
+        return is_small() ? small_capacity : buf.heap.capacity;
+    }
+
+private:
+
+    // Empty string
+    string() noexcept : length(0) {
+        buf.local[0] = '\0';
+        lifecycle_record<string>(lifecycle_event::construction);
+    }
+
+    // Move without text (the internal moves of string_concat are not the user's ones), still counted
+    struct take_t {};
+    string(take_t, string &that) noexcept : length(that.length), buf(that.buf) {
+        that.reset();
+        lifecycle_record<string>(lifecycle_event::move);
+    }
+
+    bool is_small() const {
+        return length <= small_capacity;
+    }
+
+    bool is_borrowed() const {
+        return !is_small() && buf.heap.capacity == 0;
+    }
+
+    void reset() {
+        length = 0;
+        buf.local[0] = '\0';
+    }
+
+    // Set the length of a new string, allocate if it does not fit inline.
+    // Return the buffer to be filled with 'size' chars, already null terminated.
+    char* init(size_t size) {
+        length = size;
+        char *data = buf.local;
+        if (!is_small()) {
+            data = new char[size + 1];
+            buf.heap = {data, size};
+        }
+        data[size] = '\0';
+        return data;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Lazy concatenation: one link per append
+//
+// A link records its piece and references the previous link, so appending is O(1) whatever the
+// length of the chain. Like every expression template, the previous links, the pieces and the head
+// (when it is an lvalue) are referenced, not copied: convert the chain to string in the same
+// full-expression, e.g. do not keep it in an 'auto' variable.
+
+class string_concat {
+    friend class string;
+
+    string_concat *prev;           // nullptr for the first link (a string_concat_head)
+    const char *piece;
+    size_t pieceSize;
+    size_t size;                   // Total length of the chain up to this link
+    size_t count;                  // Number of pieces up to this link, head included
+
+public:
+
+    string_concat(const string_concat &) = delete;
+    string_concat& operator=(const string_concat &) = delete;
+
+    string_concat append(const char *p) && {
+        return string_concat(this, p);
+    }
+
+    // Single allocation sized to the total length (none when the result fits inline or when the
+    // owned head has enough capacity), pieces are written from the last one
+    operator string() &&;
+
+protected:
+
+    // First link, after a head of 'headSize' chars
+    string_concat(size_t headSize, const char *p)
+        : prev(nullptr), piece(p), pieceSize(std::strlen(p)), size(headSize + pieceSize), count(2) {}
+
+private:
+
+    string_concat(string_concat *prevLink, const char *p)
+        : prev(prevLink), piece(p), pieceSize(std::strlen(p)), size(prevLink->size + pieceSize),
+          count(prevLink->count + 1) {}
+};
+
+// First link of a chain: the only one holding the head, the next links only record their piece
+class string_concat_head : public string_concat {
+    friend class string;
+    friend class string_concat;
+
+    string owned;                  // Head taken over from an rvalue string
+    const string *head;            // Head referenced from an lvalue string, nullptr when 'owned'
+
+    string_concat_head(string &&ownedHead, const char *p)
+        : string_concat(ownedHead.size(), p), owned(string::take_t(), ownedHead), head(nullptr) {}
+
+    string_concat_head(const string &borrowedHead, const char *p)
+        : string_concat(borrowedHead.size(), p), owned(), head(&borrowedHead) {}
+};
+
+inline string_concat::operator string() && {
+    lifecycle_trace([this](std::ostream &os) { os << "concat " << count << " pieces" << std::endl; });
+    string_concat *firstLink = this;
+    while (firstLink->prev != nullptr) {
+        firstLink = firstLink->prev;
+    }
+    string_concat_head *first = static_cast<string_concat_head *>(firstLink);
+
+    const bool reuse = first->head == nullptr && first->owned.capacity() >= size;
+    string result = reuse ? string(string::take_t(), first->owned) : string();
+    char *data;
+    if (reuse) {
+        data = const_cast<char *>(result.c_str());
+        result.length = size;
+        data[size] = '\0';
+    } else {
+        const string &h = first->head != nullptr ? *first->head : first->owned;
+        data = result.init(size);
+        std::memcpy(data, h.c_str(), h.size());
+    }
+
+    char *out = data + size;
+    for (const string_concat *link = this; link != nullptr; link = link->prev) {
+        out -= link->pieceSize;
+        std::memcpy(out, link->piece, link->pieceSize);
+    }
+    return result; // NRVO
+}
+
+inline string_concat_head string::append(const char *p) && {
+    lifecycle_trace([](std::ostream &os) { os << "append move" << std::endl; });
+    return string_concat_head(std::move(*this), p);
+}
+
+inline string_concat_head string::append(const char *p) const & {
+    lifecycle_trace([](std::ostream &os) { os << "append copy" << std::endl; });
+    return string_concat_head(*this, p);
+}
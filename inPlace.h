@@ -0,0 +1,38 @@
+#pragma once
+
+#include <tuple>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Members built directly in their final storage, without copy nor move
+//
+// A constructor taking the member by value or by reference moves it in (MyClass(MS&&) : a(move(aIn))).
+// Taking the constructor arguments of the member instead, and calling a factory in the member
+// initializer, builds it in place: the factory returns a prvalue, which initializes the member
+// itself (C++17 guaranteed copy elision). It works for const and non-movable members.
+//
+// struct Owner {
+//     const Member m;
+//     template <class... Args>
+//     Owner(in_place_factory<Member, Args...> makeM) : m(std::move(makeM)()) {}
+// };
+// Owner o(build_in_place<Member>(1, "x"));
+
+// Forwarded constructor arguments of a T (references: use it in the full expression only)
+template <class T, class... Args>
+class in_place_factory {
+	std::tuple<Args&&...> args;
+
+public:
+	explicit in_place_factory(Args&&... args) : args(std::forward<Args>(args)...) {}
+
+	// Once: the arguments are forwarded (moved from when rvalues)
+	T operator()() && {
+		return std::make_from_tuple<T>(std::move(args));
+	}
+};
+
+template <class T, class... Args>
+in_place_factory<T, Args...> build_in_place(Args&&... args) {
+	return in_place_factory<T, Args...>(std::forward<Args>(args)...);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Polymorphic value stored in place
+//
+// inplace_poly<Base, Size> holds any implementation of 'Base' in an aligned inline buffer of 'Size'
+// bytes: a factory can return an abstract type by value, without heap allocation nor slicing.
+// Calls go through the virtual methods of 'Base'. Copies and moves copy or move the stored
+// implementation. An implementation too large for the buffer does not compile.
+//
+// inplace_poly<MyType, 64> m = MyTypeSubImpl();
+// m->f();
+
+template <class Base, std::size_t Size, std::size_t Align = alignof(std::max_align_t)>
+class inplace_poly {
+	// Type erased special members of the stored implementation, one table per type
+	struct operations {
+		Base* (*copy)(const void* from, void* to);
+		Base* (*move)(void* from, void* to) noexcept;
+		void (*destroy)(void* object) noexcept;
+	};
+
+	template <class T>
+	struct operations_of {
+		static Base* copy(const void* from, void* to) {
+			return ::new (to) T(*static_cast<const T*>(from));
+		}
+		static Base* move(void* from, void* to) noexcept {
+			return ::new (to) T(std::move(*static_cast<T*>(from)));
+		}
+		static void destroy(void* object) noexcept {
+			static_cast<T*>(object)->~T();
+		}
+		static constexpr operations table = {&copy, &move, &destroy};
+	};
+
+	template <class T>
+	static constexpr void check() {
+		static_assert(std::is_base_of_v<Base, T>, "inplace_poly: not an implementation of Base");
+		static_assert(sizeof(T) <= Size, "inplace_poly: implementation too large for the buffer");
+		static_assert(alignof(T) <= Align, "inplace_poly: implementation over-aligned for the buffer");
+		static_assert(std::is_copy_constructible_v<T>, "inplace_poly: implementation not copyable");
+		static_assert(std::is_nothrow_move_constructible_v<T>, "inplace_poly: move could throw");
+	}
+
+	alignas(Align) unsigned char storage[Size];
+	const operations* ops;
+	Base* base; // Points into 'storage' (the offset of Base could be non zero)
+
+public:
+	template <class T, class = std::enable_if_t<!std::is_same_v<std::decay_t<T>, inplace_poly>>>
+	inplace_poly(T&& implementation) {
+		using Impl = std::decay_t<T>;
+		check<Impl>();
+		base = ::new (storage) Impl(std::forward<T>(implementation));
+		ops = &operations_of<Impl>::table;
+	}
+
+	template <class T, class... Args>
+	explicit inplace_poly(std::in_place_type_t<T>, Args&&... args) {
+		check<T>();
+		base = ::new (storage) T(std::forward<Args>(args)...);
+		ops = &operations_of<T>::table;
+	}
+
+	inplace_poly(const inplace_poly& other) : ops(other.ops) {
+		base = ops->copy(other.storage, storage);
+	}
+
+	// 'other' keeps a moved-from implementation
+	inplace_poly(inplace_poly&& other) noexcept : ops(other.ops) {
+		base = ops->move(other.storage, storage);
+	}
+
+	inplace_poly& operator=(const inplace_poly& other) {
+		if (this != &other) {
+			inplace_poly copy(other); // could throw: *this left untouched
+			*this = std::move(copy);
+		}
+		return *this;
+	}
+
+	inplace_poly& operator=(inplace_poly&& other) noexcept {
+		if (this != &other) {
+			ops->destroy(storage);
+			ops = other.ops;
+			base = ops->move(other.storage, storage);
+		}
+		return *this;
+	}
+
+	~inplace_poly() {
+		ops->destroy(storage);
+	}
+
+	Base* get() { return base; }
+	const Base* get() const { return base; }
+	Base& operator*() { return *base; }
+	const Base& operator*() const { return *base; }
+	Base* operator->() { return base; }
+	const Base* operator->() const { return base; }
+};
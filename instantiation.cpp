@@ -2,6 +2,21 @@
 #include <string>
 
 #include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <vector>
+
+#include "experiments.h"
+#include "inPlace.h"
+#include "inplacePoly.h"
+#include "instrumentedTypes.h"
+#include "intrusivePtr.h"
+#include "ownerPtr.h"
+#include "polyCollection.h"
+#include "poolAllocator.h"
+#include "retentionTracker.h"
+#include "slotMap.h"
+#include "uniqueValue.h"
 
 using std::cout, std::endl,
 std::string,
@@ -24,6 +39,64 @@ void uniquePtr() {
 // aa valid: 1
 // valid: 0
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// owner_ptr & ref_ptr (see thinkingAboutSmartPointer.txt and ownerPtr.h)
+
+void ownerPtr() {
+	owner_ptr<string, counting_policy> owner = make_owner<string, counting_policy>("bb");
+	ref_ptr<string, counting_policy> ref = owner;
+	cout << *ref << " references: " << owner.ref_count() << endl;
+	// delete ref.get(); // compiles but forbidden: only the owner deletes (no ref.reset())
+
+	try {
+		owner.reset(); // 'ref' is still alive
+	} catch (const dangling_reference_error& e) {
+		cout << e.what() << " / valid: " << (bool)owner << endl;
+	}
+
+	ref = nullptr;
+	owner.reset();
+	cout << "valid: " << (bool)owner << endl;
+
+	cout << sizeof(ref_ptr<string, unchecked_policy>) << " / " << sizeof(ref_ptr<string, counting_policy>) << endl;
+
+	cout << endl;
+}
+
+// output:
+// bb references: 1
+// owner_ptr: object deleted while referenced / valid: 1
+// valid: 0
+// 8 / 16
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Container as owner, handles as references (see slotMap.h)
+
+void slotMap() {
+	slot_map<string> owners;
+	slot_handle aa = owners.insert("aa");
+	slot_handle bb = owners.insert("bb");
+	cout << *owners.get(aa) << " / " << *owners.get(bb) << endl;
+
+	owners.erase(aa); // "bb" moved to the hole
+	slot_handle cc = owners.insert("cc"); // Reuses the slot of "aa", next generation
+	cout << "aa valid: " << owners.contains(aa) << " / same slot: " << (cc.index == aa.index)
+	     << " / get: " << owners.get(aa) << endl;
+	for (const string& s : owners) {
+		cout << s << " ";
+	}
+	cout << endl;
+	cout << sizeof(slot_handle) << endl;
+
+	cout << endl;
+}
+
+// output:
+// aa / bb
+// aa valid: 0 / same slot: 1 / get: 0
+// bb cc
+// 8
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // A default constructor is a constructor which can be called with no arguments (either defined
 // with an empty parameter list, or with default arguments provided for every parameter). A type
@@ -205,40 +278,7 @@ void testResources() {
 // r2_1 ok
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-// Copy constructors & copy assignment operator
-
-struct A
-{
-string a;
-
-A(string a)
-	: a(a)
-{
-	cout << "Constructor: " << this->a << endl;
-}
-
-// Copy constructor implicitly defined, if not user defined. Could be
-// defaulted (generated by compiler) : A(const A& other) = default;
-// deleted: A(const A& other) = delete;
-A(const A& other) // reference required but not const
-	: a(other.a)
-{
-	cout << "Copy constructor: " << this->a << endl;
-}
-
-//Copy assignable object
-// defaulted (generated by compiler) : A& operator=(const A& t) = default;
-// deleted: A& operator=(const A& t) = delete;
-A& operator=(const A& other) // Argument const and reference not mandatory, using reference for return value not mandatory but better
-{
-	cout << "Copy assignment operator" << endl;
-	if (this != &other) {
-		this->a = other.a;
-	}
-	return *this;
-}
-
-};
+// Copy constructors & copy assignment operator (A is defined in instrumentedTypes.h)
 
 void useCopyConstructor(A a)
 {
@@ -247,6 +287,7 @@ void useCopyConstructor(A a)
 
 void testCopy()
 {
+	lifecycle_text_reporter trace(cout); // Print the copies and moves
 	A a1("someString");
 	A a2(a1);
 	cout << a1.a << endl;
@@ -286,52 +327,11 @@ void testCopy()
 // useCopyConstructor: UpdatedString
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-// Move constructors & move assignment operator
-
-struct B
-{
-int* b;
-
-B(int b) : b(new int)
-{
-	*this->b = b;
-}
-
-~B() // rule of 3: destructor, copy constructor, copy assignment operator shall be defined together
-// rule of 5: add move constructor, move assignment operator
-// law of the big 2: with RAII (use of smart pointers) destructor left undefined
-// rule of 3 and half (redefine swap - copy and swap idiom)
-{
-	if (b != nullptr) {
-		delete b;
-		b = nullptr;
-	}
-}
-	
-B(B&& other) // reference to rvalue required, could be const
-	: b(other.b)
-{
-	cout << "Move constructor: " << *this->b << endl;
-	other.b = nullptr;
-}
-
-B& operator=(B&& other) // reference to rvalue required, could be const, using reference for return value not mandatory but better
-{
-	cout << "Move assignment operator" << endl;
-	if (this->b != other.b) {
-		if (b != nullptr) {
-			delete b;
-			b = nullptr;
-		}
-		this->b = other.b;
-		other.b = nullptr;
-	}
-	return *this;
-}
-};
+// Move constructors & move assignment operator (B is defined in instrumentedTypes.h)
 
 void testMove()
 {
+	lifecycle_text_reporter trace(cout);
 	B b1(5);
 	cout << "b1: " << *b1.b << " / addr: " << b1.b << endl;
 	B b2(move(b1));
@@ -357,6 +357,68 @@ void testMove()
 // b3: 5 / addr: 000001C27D4B6200
 // b2 addr: 0000000000000000
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Small allocations from a pool (see poolAllocator.h)
+
+void testPoolAllocator()
+{
+	lifecycle_text_reporter trace(cout);
+	// Same behavior as B, the int comes from the thread cache of the pool: no lock, no malloc
+	BasicB<pool_allocator<int>> b1(5);
+	BasicB<pool_allocator<int>> b2(move(b1));
+	cout << "b2: " << *b2.b << " / b1 addr: " << b1.b << endl;
+	cout << sizeof(B) << " / " << sizeof(BasicB<pool_allocator<int>>) << endl;
+
+	// std::pmr containers through the memory_resource adapter
+	pool_memory_resource pool;
+	std::pmr::vector<int> v({1, 2, 3}, &pool);
+	v.push_back(4);
+	cout << "v: " << v.size() << " elements" << endl;
+
+	cout << endl;
+}
+
+// output:
+// Move constructor: 5
+// b2: 5 / b1 addr: 0
+// 8 / 8
+// v: 4 elements
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Move-only value stored inline (see uniqueValue.h): B without the heap int
+
+struct Big {
+	char data[256];
+	int value;
+};
+
+void testUniqueValue()
+{
+	unique_value<int> v1 = make_unique_value<int>(5);
+	unique_value<int> v2(move(v1)); // Moves the int itself
+	cout << "v2: " << *v2 << " / v1: " << (v1 ? "value" : "empty") << endl;
+
+	unique_value<int> v3 = make_unique_value<int>(7);
+	v3 = move(v2);
+	cout << "v3: " << *v3 << " / v2 addr: " << v2.get() << endl;
+
+	// Too large to be inline: on the heap, a move transfers the pointer
+	unique_value<Big> big = make_unique_value<Big>();
+	const Big* before = big.get();
+	unique_value<Big> big2(move(big));
+	cout << "inline: " << unique_value<int>::is_inline << " / " << unique_value<Big>::is_inline
+	     << " / same address: " << (big2.get() == before) << endl;
+	cout << sizeof(B) << " / " << sizeof(unique_value<int>) << " / " << sizeof(unique_value<Big>) << endl;
+
+	cout << endl;
+}
+
+// output:
+// v2: 5 / v1: empty
+// v3: 5 / v2 addr: 0
+// inline: 1 / 0 / same address: 1
+// 8 / 8 / 8
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Play with reference to rvalue
 
@@ -428,39 +490,10 @@ struct F2b
 	virtual ~F2b() = default;
 };
 
-struct H
-{
-	virtual ~H() = 0;
-	virtual void f() = 0;
-};
-
-H::~H() = default;
-
-struct H1 : H
-{
-	void f() override
-	{
-		cout << "H1" << endl;
-	}
-	void g()
-	{
-		cout << "gH1" << endl;
-	}
-};
-
-struct H2 : H1
-{
-	void f() override
-	{
-		cout << "H2" << endl;
-	}
-	void g()
-	{
-		cout << "gH2" << endl;
-	}
-};
+// H -> H1 -> H2 is defined in instrumentedTypes.h
 
 void virtualMethodsBehavior() {
+	lifecycle_text_reporter trace(cout); // Print the calls of H1/H2
 	F* f = new F1;
 	delete f;
 	f = new F2;
@@ -499,21 +532,66 @@ void virtualMethodsBehavior() {
 // gH1
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-// Cascade move semantics
+// Intrusive reference counting (see intrusivePtr.h)
 
-struct MS {
-	MS() = default;
+// The count is added by the mixin: one allocation per object, no control block
+struct CountedH2 : H2, ref_counted<CountedH2, single_thread_counter> {};
 
-	MS(const MS& other) {
-		cout << "MS_copy ";
-	}
+void intrusivePtr() {
+	lifecycle_text_reporter trace(cout);
+	intrusive_ptr<CountedH2> h = make_intrusive<CountedH2>();
+	intrusive_ptr<CountedH2> h2 = h;
+	H* base = h2.get();
+	base->f();
+	cout << "use count: " << h->use_count() << endl;
+	h2.reset();
+	cout << "use count: " << h->use_count() << endl;
 
-	MS(MS&& other) {
-		cout << "MS_move ";
-	}
+	CountedH2 copy = *h; // the count is not copied
+	cout << "copy use count: " << copy.use_count() << endl;
 
-	void f() {}
-};
+	cout << sizeof(intrusive_ptr<CountedH2>) << " // " << sizeof(std::shared_ptr<H2>) << endl;
+
+	cout << endl;
+}
+
+// output:
+// H2
+// use count: 2
+// use count: 1
+// copy use count: 0
+// 8 // 16
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Polymorphic collection: one contiguous segment per dynamic type (see polyCollection.h)
+
+void polyCollection() {
+	lifecycle_text_reporter trace(cout);
+	poly_collection<H> hs;
+	hs.insert(H2());
+	hs.insert(H1());
+	hs.insert(H2());
+	// H& h = ...; hs.insert(h); // asserts: 'h' would be sliced to H
+
+	hs.for_each([](H& h) { h.f(); }); // Virtual calls, segment by segment
+	hs.for_each<H1, H2>([](auto& h) { h.f(); }); // Called with H1& or H2&: devirtualized if they were final
+
+	cout << "size: " << hs.size() << endl;
+
+	cout << endl;
+}
+
+// output:
+// H2
+// H2
+// H1
+// H2
+// H2
+// H1
+// size: 3
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cascade move semantics (MS is defined in instrumentedTypes.h)
 
 MS buildMS() {
 	cout << "build ";
@@ -547,6 +625,7 @@ void outerRvalue(MS&& ms) {
 }
 
 void testCascadeMoveSemantics() {
+	lifecycle_text_reporter trace(cout);
 	cout << "-- 1  -- ";
 	MS ms1;
 	outer(ms1);
@@ -597,11 +676,15 @@ void testCascadeMoveSemantics() {
 // Builder
 
 struct MyClass {
-	MS a; // may be const
+	const MS a; // built once, never assigned
 
 	// aIn is moved to a: Move constructor of MS is called
 	MyClass(MS&& aIn) : a(move(aIn)) {cout << "constructor&&" << endl;}
 	MyClass(MS& aIn) : a(move(aIn)) {cout << "constructor&" << endl;}
+
+	// The arguments of MS instead of an MS: a is built in place (see inPlace.h)
+	template <class... Args>
+	MyClass(in_place_factory<MS, Args...> makeA) : a(std::move(makeA)()) {cout << "constructor in place" << endl;}
 };
 
 MyClass buildMyClass(MS a) {
@@ -616,26 +699,51 @@ MyClass build2MyClass(MS a) {
 	return MyClass(a); // Not explicit that 'a' will be invalidated in MyClass constructor
 }
 
+// Forward the arguments of MS, not an MS: no MS before the one of MyClass
+template <class... Args>
+MyClass build3MyClass(Args&&... aArgs) {
+	cout << "builder3 ";
+	return MyClass(build_in_place<MS>(std::forward<Args>(aArgs)...));
+}
+
+// Compile-time guard: a member that can be neither copied nor moved (see 'pinned' in testBuild)
+struct Pinned {
+	explicit Pinned(int) {}
+	Pinned(const Pinned&) = delete;
+	Pinned(Pinned&&) = delete;
+};
+
+struct PinnedOwner {
+	const Pinned p;
+	template <class... Args>
+	PinnedOwner(in_place_factory<Pinned, Args...> makeP) : p(std::move(makeP)()) {}
+};
+
 void testBuild() {
+	lifecycle_text_reporter trace(cout);
 	MyClass myClass  = buildMyClass(MS());
 	MyClass myClass2 = build2MyClass(MS());
+
+	lifecycle_scope scope;
+	MyClass myClass3 = build3MyClass();
+	// Compiles only if the member is built in place: Pinned has no copy nor move constructor
+	PinnedOwner pinned(build_in_place<Pinned>(1));
+	const lifecycle_counts ms = scope.delta<MS>();
+	cout << "MS copies: " << ms.copies() << " / moves: " << ms.moves() << endl;
+	if (ms.copies() + ms.moves() != 0) {
+		throw std::logic_error("testBuild: the MS of build3MyClass was copied or moved");
+	}
 	cout << endl;
 }
 
 // output:
 // builder MS_move constructor&&
 // builder2 MS_move constructor&
+// builder3 constructor in place
+// MS copies: 0 / moves: 0
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-// Return value optimization (copy elision)
-
-class RVO {
-public:
-	RVO() = default;
-	RVO(const RVO& other) {
-		cout << "COPY RVO" << endl;
-	}
-};
+// Return value optimization (copy elision, RVO is defined in instrumentedTypes.h)
 
 RVO rvo1a() {
 	RVO rvo;
@@ -675,6 +783,7 @@ RVO r1() {
 }
 
 void returnValueOptimization() {
+	lifecycle_text_reporter trace(cout);
 	cout << "Exec rvo1a" << endl;
 	RVO rvo_1a = rvo1a();
 	cout << "Exec rvo1b" << endl;
@@ -699,6 +808,36 @@ void returnValueOptimization() {
 // r1
 // r2
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copies and moves counted instead of printed (see lifecycleCounters.h)
+
+void lifecycleCounts() {
+	lifecycle_scope scope; // Events of this thread from now on
+	{
+		RVO rvo_1a = rvo1a();
+		RVO rvo_2a = rvo2a(true);
+		A a1("counted");
+		A a2 = a1;
+		a1 = a2;
+		MS ms;
+		lifecycle_site site; // Counts the events of the lines below, located here
+		outerRvalue(move(ms));
+		cout << "site: " << site.counts() << endl;
+	}
+	scope.print(cout);
+	cout << "MS copies: " << scope.delta<MS>().copies() << endl;
+
+	cout << endl;
+}
+
+// output (types by name):
+// outerRvalue inner inner innerRvalue
+// site: constructions 0, copies 1, moves 1, copy assignments 0, move assignments 0, destructions 2
+// A: constructions 1, copies 1, moves 0, copy assignments 1, move assignments 0, destructions 2
+// MS: constructions 1, copies 1, moves 1, copy assignments 0, move assignments 0, destructions 3
+// RVO: constructions 3, copies 1, moves 0, copy assignments 0, move assignments 0, destructions 4
+// MS copies: 1
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Factory on stack
 
@@ -770,7 +909,10 @@ public:
     virtual ~MyTypeSubImpl() = default;
 };
 
-const MyType& build() {
+// Polymorphic value stored on stack: any MyType implementation fitting in 64 bytes (see inplacePoly.h)
+using MyTypeValue = inplace_poly<MyType, 64>;
+
+MyTypeValue build(bool sub) {
     // const is mandatory: the l-value 'm' and 'm1' shall be const
     // otherwise the r-value 'MyTypeImpl()' could be lost if we modify 'm' or 'm1'
     // m = somethingElse; // => original object referenced by 'm' is lost
@@ -789,6 +931,7 @@ const MyType& build() {
     // Possible return type of build
     // - MyTypeImpl but return the concrete type
     // - MyType&, MyType* or smart pointer to MyType but use allocation on heap
+    // - inplace_poly<MyType, N>: any implementation by value, stored inline (no heap, no slicing)
 
     MyTypeImpl m3 = MyTypeSubImpl(); // Object slicing: we loose integer 'b' (object slicing could be more tricky than that...)
     MyTypeImpl m4 = MyTypeSubImpl();
@@ -797,20 +940,105 @@ const MyType& build() {
     // MyMixin& mi = m3;
     // mi = m4; // now m3 contains a mixture of m3 and m4 !
 
-    return MyTypeImpl(); // return reference to temporary
+    // return MyTypeImpl(); // with 'const MyType& build()': return reference to temporary
+
+    if (sub) {
+        return MyTypeSubImpl(); // No slicing: the whole MyTypeSubImpl is stored
+    }
+    return MyTypeImpl();
+}
+
+void factoryOnStack() {
+    MyTypeValue m = build(false);
+    m->f();
+    m->g();
+
+    MyTypeValue sub = build(true);
+    MyTypeValue copy = sub; // Copy a MyTypeSubImpl
+    cout << "sub: " << (dynamic_cast<const MyTypeSubImpl*>(copy.get()) != nullptr) << endl;
+
+    copy = m; // Now holds a MyTypeImpl
+    cout << "sub: " << (dynamic_cast<const MyTypeSubImpl*>(copy.get()) != nullptr) << endl;
+
+    // inplace_poly<MyType, 16> tooSmall = MyTypeImpl(); // Does not compile: implementation too large
+
+    cout << sizeof(MyTypeImpl) << " / " << sizeof(MyTypeSubImpl) << " / " << sizeof(MyTypeValue) << endl;
+
+    cout << endl;
 }
 
+// output:
+// sub: 1
+// sub: 0
+// 40 / 40 / 80
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
+// Memory leak with smart pointers: long life container (see thinkingAboutSmartPointer.txt)
+// Live instances tracked by a mixin, inherited privately as MyMixin (see retentionTracker.h)
 
-void instantiationMain()
-{
-	uniquePtr();
-	implicitInstantiation();
-	testResources();
-	testCopy();
-	testMove();
-	virtualMethodsBehavior();
-	testCascadeMoveSemantics();
-	testBuild();
-	returnValueOptimization();
+class Session : private retention_tracked<Session> {
+public:
+	static constexpr const char* retention_name = "Session";
+
+	int id;
+
+	explicit Session(int id) : id(id) {}
+};
+
+class Request : private retention_tracked<Request> {
+public:
+	static constexpr const char* retention_name = "Request";
+};
+
+std::vector<std::shared_ptr<Session>> sessionCache; // Filled, never cleaned
+
+void handle(int id) {
+	auto session = std::make_shared<Session>(id);
+	Request request;
+	sessionCache.push_back(session); // Forgotten reference: session outlives the request
 }
+
+void retainedObjects() {
+	retention_sampling(3); // Stack of 1 construction out of 3
+	retention_history history;
+	for (int round = 0; round < 3; ++round) {
+		for (int i = 0; i < 8; ++i) {
+			handle(i);
+		}
+		history.record();
+	}
+	history.print_growing(cout, false); // true: with the frames of the sites
+	history.print_live(cout);
+	sessionCache.clear();
+
+	cout << endl;
+}
+
+// output (Request is not retained):
+// Session: live 8 -> 16 -> 24 (192 bytes)
+//     site 1: sampled live 3 -> 5 -> 8
+// Session: 24 live, 192 bytes
+// Request: 0 live, 0 bytes
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const experiment_group instantiationExperiments("instantiation", {
+	{"uniquePtr", uniquePtr},
+	{"ownerPtr", ownerPtr},
+	{"slotMap", slotMap},
+	{"implicitInstantiation", implicitInstantiation},
+	{"testResources", testResources},
+	{"testCopy", testCopy},
+	{"testMove", testMove},
+	{"testPoolAllocator", testPoolAllocator},
+	{"testUniqueValue", testUniqueValue},
+	{"virtualMethodsBehavior", virtualMethodsBehavior},
+	{"intrusivePtr", intrusivePtr},
+	{"polyCollection", polyCollection},
+	{"testCascadeMoveSemantics", testCascadeMoveSemantics},
+	{"testBuild", testBuild},
+	{"returnValueOptimization", returnValueOptimization},
+	{"lifecycleCounts", lifecycleCounts},
+	{"factoryOnStack", factoryOnStack},
+	{"retainedObjects", retainedObjects, experiment::serial},
+});
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "lifecycleCounters.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Types of the experiments whose special members are counted or whose calls are traced
+// (see lifecycleCounters.h)
+//
+// The text they used to print (e.g. "MS_copy ", "H2") is written only under a
+// lifecycle_text_reporter: the benchmarks use the same types at full speed and read the counts of a
+// lifecycle_scope.
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copy constructors & copy assignment operator
+
+struct A
+{
+static constexpr const char* lifecycle_name = "A";
+
+std::string a;
+
+A(std::string a)
+	: a(a)
+{
+	lifecycle_record<A>(lifecycle_event::construction, [this](std::ostream& os) { os << "Constructor: " << this->a << std::endl; });
+}
+
+// Copy constructor implicitly defined, if not user defined. Could be
+// defaulted (generated by compiler) : A(const A& other) = default;
+// deleted: A(const A& other) = delete;
+A(const A& other) // reference required but not const
+	: a(other.a)
+{
+	lifecycle_record<A>(lifecycle_event::copy, [this](std::ostream& os) { os << "Copy constructor: " << this->a << std::endl; });
+}
+
+//Copy assignable object
+// defaulted (generated by compiler) : A& operator=(const A& t) = default;
+// deleted: A& operator=(const A& t) = delete;
+A& operator=(const A& other) // Argument const and reference not mandatory, using reference for return value not mandatory but better
+{
+	lifecycle_record<A>(lifecycle_event::copy_assignment, [](std::ostream& os) { os << "Copy assignment operator" << std::endl; });
+	if (this != &other) {
+		this->a = other.a;
+	}
+	return *this;
+}
+
+~A()
+{
+	lifecycle_record<A>(lifecycle_event::destruction);
+}
+
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Move constructors & move assignment operator
+
+// The int is allocated by 'Allocator' (e.g. pool_allocator<int>, see poolAllocator.h)
+// Private inheritance: empty base optimization, a stateless allocator takes no space
+template <class Allocator = std::allocator<int>>
+struct BasicB : private Allocator
+{
+static constexpr const char* lifecycle_name = "B";
+
+using traits = std::allocator_traits<Allocator>;
+static_assert(traits::is_always_equal::value, "B moves its int between instances: allocators shall be equal");
+
+int* b;
+
+BasicB(int b, const Allocator& allocator = Allocator()) : Allocator(allocator), b(traits::allocate(*this, 1))
+{
+	traits::construct(*this, this->b, b);
+	lifecycle_record<BasicB>(lifecycle_event::construction);
+}
+
+~BasicB() // rule of 3: destructor, copy constructor, copy assignment operator shall be defined together
+// rule of 5: add move constructor, move assignment operator
+// law of the big 2: with RAII (use of smart pointers) destructor left undefined
+// rule of 3 and half (redefine swap - copy and swap idiom)
+{
+	lifecycle_record<BasicB>(lifecycle_event::destruction);
+	if (b != nullptr) {
+		release();
+		b = nullptr;
+	}
+}
+
+BasicB(BasicB&& other) // reference to rvalue required, could be const
+	: Allocator(other), b(other.b)
+{
+	lifecycle_record<BasicB>(lifecycle_event::move, [this](std::ostream& os) { os << "Move constructor: " << *this->b << std::endl; });
+	other.b = nullptr;
+}
+
+BasicB& operator=(BasicB&& other) // reference to rvalue required, could be const, using reference for return value not mandatory but better
+{
+	lifecycle_record<BasicB>(lifecycle_event::move_assignment, [](std::ostream& os) { os << "Move assignment operator" << std::endl; });
+	if (this->b != other.b) {
+		if (b != nullptr) {
+			release();
+			b = nullptr;
+		}
+		this->b = other.b;
+		other.b = nullptr;
+	}
+	return *this;
+}
+
+private:
+
+void release() // same as: delete b;
+{
+	traits::destroy(*this, b);
+	traits::deallocate(*this, b, 1);
+}
+};
+
+using B = BasicB<>;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cascade move semantics
+
+struct MS {
+	static constexpr const char* lifecycle_name = "MS";
+
+	MS() {
+		lifecycle_record<MS>(lifecycle_event::construction);
+	}
+
+	MS(const MS&) {
+		lifecycle_record<MS>(lifecycle_event::copy, [](std::ostream& os) { os << "MS_copy "; });
+	}
+
+	MS(MS&&) {
+		lifecycle_record<MS>(lifecycle_event::move, [](std::ostream& os) { os << "MS_move "; });
+	}
+
+	~MS() {
+		lifecycle_record<MS>(lifecycle_event::destruction);
+	}
+
+	void f() {}
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Return value optimization (copy elision)
+
+class RVO {
+public:
+	static constexpr const char* lifecycle_name = "RVO";
+
+	RVO() {
+		lifecycle_record<RVO>(lifecycle_event::construction);
+	}
+	RVO(const RVO&) {
+		lifecycle_record<RVO>(lifecycle_event::copy, [](std::ostream& os) { os << "COPY RVO" << std::endl; });
+	}
+	~RVO() {
+		lifecycle_record<RVO>(lifecycle_event::destruction);
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Virtual methods: H -> H1 -> H2
+
+struct H
+{
+	virtual ~H() = 0;
+	virtual void f() = 0;
+};
+
+inline H::~H() = default;
+
+struct H1 : H
+{
+	void f() override
+	{
+		lifecycle_trace([](std::ostream& os) { os << "H1" << std::endl; });
+	}
+	void g()
+	{
+		lifecycle_trace([](std::ostream& os) { os << "gH1" << std::endl; });
+	}
+};
+
+struct H2 : H1
+{
+	void f() override
+	{
+		lifecycle_trace([](std::ostream& os) { os << "H2" << std::endl; });
+	}
+	void g()
+	{
+		lifecycle_trace([](std::ostream& os) { os << "gH2" << std::endl; });
+	}
+};
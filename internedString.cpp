@@ -0,0 +1,123 @@
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "internedString.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sharded pool: open addressing tables of entries, entries carved from chunks
+
+namespace {
+
+constexpr std::size_t shardBits = 6;                 // 64 shards, chosen by the top bits of the hash
+constexpr std::size_t shardCount = std::size_t(1) << shardBits;
+constexpr std::size_t chunkSize = 16 * 1024;         // Memory requested to the system at once
+constexpr std::size_t entryAlignment = alignof(interned_string::entry);
+
+using entry = interned_string::entry;
+
+// One shard: its own lock, table and chunks, on its own cache lines
+class alignas(64) Shard {
+	std::mutex m;
+	std::vector<const entry*> table;                 // Power of 2 slots, at most half full
+	std::size_t count = 0;
+	char* chunk = nullptr;                           // Free part of the current chunk
+	std::size_t chunkLeft = 0;
+	std::size_t bytes = 0;
+
+	// Memory of a new entry (m locked): from the current chunk, large values alone
+	void* allocate(std::size_t size) {
+		size = (size + entryAlignment - 1) & ~(entryAlignment - 1);
+		if (size > chunkSize / 4) {
+			bytes += size;
+			return ::operator new(size);
+		}
+		if (size > chunkLeft) {
+			chunk = static_cast<char*>(::operator new(chunkSize));
+			chunkLeft = chunkSize;
+			bytes += chunkSize;
+		}
+		void* p = chunk;
+		chunk += size;
+		chunkLeft -= size;
+		return p;
+	}
+
+	// Double the table (m locked)
+	void grow() {
+		std::vector<const entry*> larger(table.empty() ? 64 : table.size() * 2, nullptr);
+		const std::size_t mask = larger.size() - 1;
+		for (const entry* e : table) {
+			if (e != nullptr) {
+				std::size_t i = e->hash & mask;
+				while (larger[i] != nullptr) {
+					i = (i + 1) & mask;
+				}
+				larger[i] = e;
+			}
+		}
+		bytes += (larger.size() - table.size()) * sizeof(const entry*);
+		table.swap(larger);
+	}
+
+public:
+	const entry* intern(std::string_view s, std::size_t hash) {
+		std::lock_guard<std::mutex> lk(m);
+		if (2 * (count + 1) > table.size()) {
+			grow();
+		}
+		const std::size_t mask = table.size() - 1;
+		std::size_t i = hash & mask;
+		for (; table[i] != nullptr; i = (i + 1) & mask) {
+			const entry* e = table[i];
+			if (e->hash == hash && e->size == s.size() && std::memcmp(e->chars(), s.data(), s.size()) == 0) {
+				return e;
+			}
+		}
+		void* memory = allocate(sizeof(entry) + s.size() + 1);
+		entry* e = ::new (memory) entry{hash, s.size()};
+		char* chars = const_cast<char*>(e->chars());
+		std::memcpy(chars, s.data(), s.size());
+		chars[s.size()] = '\0';
+		table[i] = e;
+		++count;
+		return e;
+	}
+
+	void addStatistics(interned_string::pool_statistics& statistics) {
+		std::lock_guard<std::mutex> lk(m);
+		statistics.values += count;
+		statistics.bytes += bytes;
+	}
+};
+
+// Never destroyed: handles may be used by static destructors
+Shard* shards() {
+	static Shard* const shards = new Shard[shardCount];
+	return shards;
+}
+
+Shard& shardOf(std::size_t hash) {
+	return shards()[hash >> (8 * sizeof(std::size_t) - shardBits)];
+}
+
+} // namespace
+
+interned_string::interned_string() {
+	static const entry* const empty = intern({});
+	e = empty;
+}
+
+const interned_string::entry* interned_string::intern(std::string_view s) {
+	const std::size_t hash = std::hash<std::string_view>()(s);
+	return shardOf(hash).intern(s, hash);
+}
+
+interned_string::pool_statistics interned_string::statistics() {
+	pool_statistics statistics;
+	for (std::size_t s = 0; s < shardCount; ++s) {
+		shards()[s].addStatistics(statistics);
+	}
+	return statistics;
+}
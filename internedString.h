@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string_view>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Interned immutable string: one canonical buffer per distinct value
+//
+// interning a value looks it up in a global pool and returns a handle to its unique entry (created
+// on first use), which also stores the hash. As equal values share the entry:
+// - equality is a pointer compare, hashing a field load (std::hash below: unordered_map keys)
+// - a copy is a pointer copy, N copies of a value hold its chars once
+// The pool is split in shards (by hash), each with its own lock: concurrent interning of different
+// values rarely waits. Entries are never freed (the values of a program: keys, names, tags...):
+// interning unbounded user input would grow the pool forever.
+
+class interned_string {
+public:
+	// Entry of the pool, followed by size + 1 chars
+	struct entry {
+		std::size_t hash;
+		std::size_t size;
+
+		const char* chars() const { return reinterpret_cast<const char*>(this + 1); }
+	};
+
+	struct pool_statistics {
+		std::size_t values = 0;   // Distinct values (entries)
+		std::size_t bytes = 0;    // Memory of the entries and of the tables
+	};
+
+	// The empty string
+	interned_string();
+
+	explicit interned_string(const char* p) : interned_string(std::string_view(p)) {}
+	explicit interned_string(std::string_view s) : e(intern(s)) {}
+
+	const char* c_str() const { return e->chars(); }
+	std::size_t size() const { return e->size; }
+	std::size_t hash() const { return e->hash; }
+	std::string_view view() const { return {e->chars(), e->size}; }
+
+	friend bool operator==(interned_string a, interned_string b) { return a.e == b.e; }
+	friend bool operator!=(interned_string a, interned_string b) { return a.e != b.e; }
+
+	friend std::ostream& operator<<(std::ostream& os, interned_string s) { return os << s.view(); }
+
+	// Statistics of the global pool, all the shards
+	static pool_statistics statistics();
+
+private:
+	const entry* e;
+
+	static const entry* intern(std::string_view s);
+};
+
+// Drop-in key of the unordered containers (std::equal_to uses operator==)
+namespace std {
+template <>
+struct hash<interned_string> {
+	std::size_t operator()(interned_string s) const noexcept { return s.hash(); }
+};
+} // namespace std
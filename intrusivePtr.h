@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Intrusive reference counting
+//
+// The count lives in the object through the ref_counted mixin: intrusive_ptr is a raw pointer
+// (8 bytes, shared_ptr is 16) and there is one allocation per object, no control block.
+//
+// struct Node : ref_counted<Node> { ... };
+// intrusive_ptr<Node> n = make_intrusive<Node>();
+
+// Counter for objects used by a single thread
+struct single_thread_counter {
+	using type = std::size_t;
+
+	static void increment(type& c) { ++c; }
+	// Return true when the last reference is released
+	static bool decrement(type& c) { return --c == 0; }
+	static std::size_t load(const type& c) { return c; }
+};
+
+// Counter for objects shared between threads
+struct thread_safe_counter {
+	using type = std::atomic<std::size_t>;
+
+	static void increment(type& c) { c.fetch_add(1, std::memory_order_relaxed); }
+	// acq_rel: every use of the object happens before its deletion
+	static bool decrement(type& c) { return c.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+	static std::size_t load(const type& c) { return c.load(std::memory_order_relaxed); }
+};
+
+// Mixin holding the count. 'Derived' is the type deleted when the count drops to zero: it shall be
+// the most derived type or a base with a virtual destructor.
+// The count is not part of the value of the object: copies start with their own count.
+template <class Derived, class Counter = thread_safe_counter>
+class ref_counted {
+private:
+	mutable typename Counter::type refs{0};
+
+public:
+	// Number of intrusive_ptr to this object
+	std::size_t use_count() const { return Counter::load(refs); }
+
+	friend void intrusive_ptr_add_ref(const ref_counted* p) {
+		Counter::increment(p->refs);
+	}
+
+	friend void intrusive_ptr_release(const ref_counted* p) {
+		if (Counter::decrement(p->refs)) {
+			delete static_cast<const Derived*>(p);
+		}
+	}
+
+protected:
+	ref_counted() = default;
+	ref_counted(const ref_counted&) {}
+	ref_counted& operator=(const ref_counted&) { return *this; }
+	~ref_counted() = default;
+};
+
+template <class T>
+class intrusive_ptr {
+	template <class U>
+	friend class intrusive_ptr;
+
+	T* ptr = nullptr;
+
+public:
+	intrusive_ptr() = default;
+	intrusive_ptr(std::nullptr_t) {}
+
+	// addRef = false adopts a reference already counted
+	explicit intrusive_ptr(T* p, bool addRef = true) : ptr(p) {
+		if (ptr != nullptr && addRef) {
+			intrusive_ptr_add_ref(ptr);
+		}
+	}
+
+	intrusive_ptr(const intrusive_ptr& other) : intrusive_ptr(other.ptr) {}
+
+	template <class U>
+	intrusive_ptr(const intrusive_ptr<U>& other) : intrusive_ptr(other.ptr) {}
+
+	intrusive_ptr(intrusive_ptr&& other) noexcept : ptr(other.ptr) {
+		other.ptr = nullptr;
+	}
+
+	template <class U>
+	intrusive_ptr(intrusive_ptr<U>&& other) noexcept : ptr(other.ptr) {
+		other.ptr = nullptr;
+	}
+
+	~intrusive_ptr() {
+		if (ptr != nullptr) {
+			intrusive_ptr_release(ptr);
+		}
+	}
+
+	intrusive_ptr& operator=(intrusive_ptr other) noexcept {
+		swap(other);
+		return *this;
+	}
+
+	void reset() {
+		intrusive_ptr().swap(*this);
+	}
+
+	void swap(intrusive_ptr& other) noexcept {
+		std::swap(ptr, other.ptr);
+	}
+
+	T* get() const { return ptr; }
+	T& operator*() const { return *ptr; }
+	T* operator->() const { return ptr; }
+	explicit operator bool() const { return ptr != nullptr; }
+
+	friend bool operator==(const intrusive_ptr& a, const intrusive_ptr& b) { return a.ptr == b.ptr; }
+	friend bool operator!=(const intrusive_ptr& a, const intrusive_ptr& b) { return a.ptr != b.ptr; }
+};
+
+template <class T, class... Args>
+intrusive_ptr<T> make_intrusive(Args&&... args) {
+	return intrusive_ptr<T>(new T(std::forward<Args>(args)...));
+}
+
+static_assert(sizeof(intrusive_ptr<int>) == sizeof(int*), "intrusive_ptr shall be a raw pointer");
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Value computed by a const method on first use, then cached
+//
+// class Document {
+//     lazy<std::size_t> wordCount;
+// public:
+//     std::size_t words() const { return wordCount.get([&] { return countWords(); }); }
+//     void append(...) { ...; wordCount.invalidate(); }
+// };
+//
+// Instead of a hand-rolled mutable mutex + mutable cache: the first get() computes the value once
+// under the lock (double-checked: concurrent first calls wait for it, then return it), later calls
+// are a single acquire load, without lock.
+// invalidate() is for non-const methods: like any modification, not concurrent with get().
+// If the computation throws, nothing is cached and the next get() computes again.
+
+template <class T>
+class lazy {
+	mutable std::atomic<bool> ready{false};
+	mutable std::mutex m;
+	mutable std::optional<T> value;
+
+	template <class F>
+	const T& compute(F&& f) const {
+		std::lock_guard<std::mutex> lk(m);
+		if (!ready.load(std::memory_order_relaxed)) {
+			value.emplace(std::forward<F>(f)());
+			ready.store(true, std::memory_order_release);
+		}
+		return *value;
+	}
+
+public:
+	lazy() = default;
+
+	// The cached value is copied (a lazy is a member: its owner is copied)
+	lazy(const lazy& other) {
+		if (other.ready.load(std::memory_order_acquire)) {
+			value = other.value;
+			ready.store(true, std::memory_order_relaxed);
+		}
+	}
+
+	lazy& operator=(const lazy& other) {
+		if (this != &other) {
+			invalidate();
+			if (other.ready.load(std::memory_order_acquire)) {
+				value = other.value;
+				ready.store(true, std::memory_order_relaxed);
+			}
+		}
+		return *this;
+	}
+
+	// f() computes the value, called once
+	template <class F>
+	const T& get(F&& f) const {
+		if (ready.load(std::memory_order_acquire)) {
+			return *value;
+		}
+		return compute(std::forward<F>(f));
+	}
+
+	bool has_value() const {
+		return ready.load(std::memory_order_acquire);
+	}
+
+	void invalidate() {
+		ready.store(false, std::memory_order_relaxed);
+		value.reset();
+	}
+};
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include "lifecycleCounters.h"
+
+lifecycle_counts& lifecycle_counts::operator+=(const lifecycle_counts& other) {
+	for (std::size_t e = 0; e < lifecycle_event_count; ++e) {
+		events[e] += other.events[e];
+	}
+	return *this;
+}
+
+lifecycle_counts lifecycle_counts::operator-(const lifecycle_counts& other) const {
+	lifecycle_counts result;
+	for (std::size_t e = 0; e < lifecycle_event_count; ++e) {
+		result.events[e] = events[e] - other.events[e];
+	}
+	return result;
+}
+
+std::ostream& operator<<(std::ostream& os, const lifecycle_counts& counts) {
+	return os << "constructions " << counts.constructions() << ", copies " << counts.copies()
+		<< ", moves " << counts.moves() << ", copy assignments " << counts.copyAssignments()
+		<< ", move assignments " << counts.moveAssignments() << ", destructions " << counts.destructions();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Registry of the types and of the blocks of the threads
+
+namespace lifecycle_detail {
+
+thread_local thread_counters* local = nullptr;
+thread_local std::ostream* textOutput = nullptr;
+thread_local bool textSites = false;
+thread_local lifecycle_site* currentSite = nullptr;
+
+} // namespace lifecycle_detail
+
+namespace {
+
+using lifecycle_detail::thread_counters;
+
+struct Registry {
+	std::mutex m;
+	const char* names[max_lifecycle_types] = {};
+	std::size_t typeCount = 0;
+	bool overflowReported = false;
+	std::vector<thread_counters*> threads;
+	lifecycle_counts exited[max_lifecycle_types]; // Counts of the threads that have ended
+};
+
+// Never destroyed: events can happen in static destructors
+Registry& registry() {
+	static Registry* const r = new Registry;
+	return *r;
+}
+
+lifecycle_counts load(const thread_counters& counters, std::size_t type) {
+	lifecycle_counts result;
+	for (std::size_t e = 0; e < lifecycle_event_count; ++e) {
+		result.events[e] = counters.counts[type][e].load(std::memory_order_relaxed);
+	}
+	return result;
+}
+
+// Fold the block of the thread into 'exited' at the end of the thread
+struct ThreadExit {
+	bool registered = false;
+
+	~ThreadExit() {
+		thread_counters* counters = lifecycle_detail::local;
+		if (counters == nullptr) {
+			return;
+		}
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lk(r.m);
+		for (std::size_t t = 0; t < r.typeCount; ++t) {
+			r.exited[t] += load(*counters, t);
+		}
+		for (auto it = r.threads.begin(); it != r.threads.end(); ++it) {
+			if (*it == counters) {
+				r.threads.erase(it);
+				break;
+			}
+		}
+		delete counters;
+		// Events after this point (thread_local destructors) register a new block, never folded
+		lifecycle_detail::local = nullptr;
+	}
+};
+
+thread_local ThreadExit threadExit;
+
+// Counts of each type of the current thread or of all of them
+void snapshot(lifecycle_scope::threads which, lifecycle_counts (&out)[max_lifecycle_types]) {
+	if (which == lifecycle_scope::current_thread) {
+		// The block of the thread, without lock: the counters of the types not registered yet are 0
+		thread_counters* counters = lifecycle_detail::local;
+		for (std::size_t t = 0; t < max_lifecycle_types; ++t) {
+			out[t] = counters != nullptr ? load(*counters, t) : lifecycle_counts();
+		}
+		return;
+	}
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lk(r.m);
+	for (std::size_t t = 0; t < max_lifecycle_types; ++t) {
+		out[t] = lifecycle_counts();
+		if (t < r.typeCount) {
+			out[t] = r.exited[t];
+			for (thread_counters* counters : r.threads) {
+				out[t] += load(*counters, t);
+			}
+		}
+	}
+}
+
+} // namespace
+
+namespace lifecycle_detail {
+
+thread_counters* registerThread() {
+	thread_counters* counters = new thread_counters();
+	{
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lk(r.m);
+		r.threads.push_back(counters);
+	}
+	if (!threadExit.registered) {
+		threadExit.registered = true; // First use: odr-use registers its destructor
+	}
+	local = counters;
+	return counters;
+}
+
+// Never throws: the first event of a type can come from a noexcept move
+std::size_t registerType(const char* name) noexcept {
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lk(r.m);
+	if (r.typeCount == max_lifecycle_types) {
+		if (!r.overflowReported) {
+			r.overflowReported = true;
+			std::cerr << "lifecycle counters: more than " << max_lifecycle_types << " instrumented types, the events of "
+			          << name << " and of the next ones are not counted" << std::endl;
+		}
+		return overflow_type;
+	}
+	r.names[r.typeCount] = name;
+	return r.typeCount++;
+}
+
+} // namespace lifecycle_detail
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Site, reporter and scope
+
+lifecycle_site::lifecycle_site(call_site where) : site(where), outer(lifecycle_detail::currentSite) {
+	lifecycle_detail::currentSite = this;
+}
+
+lifecycle_site::~lifecycle_site() {
+	lifecycle_detail::currentSite = outer;
+}
+
+lifecycle_text_reporter::lifecycle_text_reporter(std::ostream& os, bool sites)
+	: previous(lifecycle_detail::textOutput), previousSites(lifecycle_detail::textSites) {
+	lifecycle_detail::textOutput = &os;
+	lifecycle_detail::textSites = sites;
+}
+
+lifecycle_text_reporter::~lifecycle_text_reporter() {
+	lifecycle_detail::textOutput = previous;
+	lifecycle_detail::textSites = previousSites;
+}
+
+lifecycle_scope::lifecycle_scope(threads which) : which(which) {
+	snapshot(which, start);
+}
+
+lifecycle_counts lifecycle_scope::delta(std::size_t typeId) const {
+	if (typeId == lifecycle_detail::overflow_type) {
+		return lifecycle_counts(); // Not counted
+	}
+	lifecycle_counts now[max_lifecycle_types];
+	snapshot(which, now);
+	return now[typeId] - start[typeId];
+}
+
+lifecycle_counts lifecycle_scope::delta() const {
+	lifecycle_counts now[max_lifecycle_types];
+	snapshot(which, now);
+	lifecycle_counts total;
+	for (std::size_t t = 0; t < max_lifecycle_types; ++t) {
+		total += now[t] - start[t];
+	}
+	return total;
+}
+
+void lifecycle_scope::print(std::ostream& os) const {
+	lifecycle_counts now[max_lifecycle_types];
+	snapshot(which, now);
+	Registry& r = registry();
+	std::size_t typeCount;
+	{
+		std::lock_guard<std::mutex> lk(r.m);
+		typeCount = r.typeCount;
+	}
+	// By name: the ids depend on the order of first use, which differs between threads and runs
+	std::vector<std::size_t> byName(typeCount);
+	for (std::size_t t = 0; t < typeCount; ++t) {
+		byName[t] = t;
+	}
+	std::sort(byName.begin(), byName.end(), [&r](std::size_t a, std::size_t b) {
+		return std::strcmp(r.names[a], r.names[b]) < 0;
+	});
+	for (std::size_t t : byName) {
+		const lifecycle_counts d = now[t] - start[t];
+		bool any = false;
+		for (std::uint64_t count : d.events) {
+			any = any || count != 0;
+		}
+		if (any) {
+			os << r.names[t] << ": " << d << std::endl;
+		}
+	}
+}
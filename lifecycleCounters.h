@@ -0,0 +1,189 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copy/move event counters
+//
+// Instrumented types (MS, A, B, RVO, string...) report their special members here instead of
+// writing to std::cout:
+//
+// struct MS {
+//     static constexpr const char* lifecycle_name = "MS";
+//     MS(const MS&) { lifecycle_record<MS>(lifecycle_event::copy, [](std::ostream& os) { os << "MS_copy "; }); }
+// };
+//
+// Each thread counts in its own block (relaxed atomics written by their thread only: no lock, no
+// contended cache line). A lifecycle_scope returns the deltas since its creation.
+// The text is written only when a lifecycle_text_reporter is installed in the thread: without it,
+// an event costs an increment and a test.
+// A lifecycle_site declared in the code under study tags the events of the thread while alive: they
+// are counted for it too, and the reporter can print its location.
+// Up to max_lifecycle_types types are counted: the events of the next ones are dropped, which is
+// reported once on std::cerr (an event never throws, it can come from a noexcept move).
+
+enum class lifecycle_event : unsigned {
+	construction,     // Any constructor but copy and move
+	copy,
+	move,
+	copy_assignment,
+	move_assignment,
+	destruction,
+};
+
+constexpr std::size_t lifecycle_event_count = 6;
+constexpr std::size_t max_lifecycle_types = 64;
+
+// Source location, of the caller by default
+struct call_site {
+	const char* file;
+	unsigned line;
+
+	static call_site current(const char* file = __builtin_FILE(), unsigned line = __builtin_LINE()) {
+		return {file, line};
+	}
+};
+
+// Counts of one type (or of all types)
+struct lifecycle_counts {
+	std::uint64_t events[lifecycle_event_count] = {};
+
+	std::uint64_t operator[](lifecycle_event e) const { return events[static_cast<unsigned>(e)]; }
+
+	std::uint64_t constructions() const { return (*this)[lifecycle_event::construction]; }
+	std::uint64_t copies() const { return (*this)[lifecycle_event::copy]; }
+	std::uint64_t moves() const { return (*this)[lifecycle_event::move]; }
+	std::uint64_t copyAssignments() const { return (*this)[lifecycle_event::copy_assignment]; }
+	std::uint64_t moveAssignments() const { return (*this)[lifecycle_event::move_assignment]; }
+	std::uint64_t destructions() const { return (*this)[lifecycle_event::destruction]; }
+
+	lifecycle_counts& operator+=(const lifecycle_counts& other);
+	lifecycle_counts operator-(const lifecycle_counts& other) const;
+};
+
+std::ostream& operator<<(std::ostream& os, const lifecycle_counts& counts);
+
+// Tag of the code making copies and moves: counts the events of the thread (all types) while it is
+// the innermost site of the thread. Its location is the line declaring it.
+//
+// lifecycle_site site;
+// MS copy = ms;            // site.counts().copies() == 1
+class lifecycle_site {
+public:
+	explicit lifecycle_site(call_site where = call_site::current());
+	~lifecycle_site();
+
+	lifecycle_site(const lifecycle_site&) = delete;
+	lifecycle_site& operator=(const lifecycle_site&) = delete;
+
+	const call_site& where() const { return site; }
+	const lifecycle_counts& counts() const { return c; }
+
+	// Single threaded: only the thread declaring the site counts in it
+	void count(lifecycle_event e) { ++c.events[static_cast<unsigned>(e)]; }
+
+private:
+	call_site site;
+	lifecycle_counts c;
+	lifecycle_site* outer;
+};
+
+namespace lifecycle_detail {
+
+// Id of the types registered beyond max_lifecycle_types: their events are dropped
+constexpr std::size_t overflow_type = max_lifecycle_types;
+
+// Block of counters of one thread (and the row of the dropped events)
+struct thread_counters {
+	std::atomic<std::uint64_t> counts[max_lifecycle_types + 1][lifecycle_event_count];
+};
+
+// Constant initialized: no guard on the fast path. Registered by the first event of the thread.
+extern thread_local thread_counters* local;
+extern thread_local std::ostream* textOutput;
+extern thread_local bool textSites;
+extern thread_local lifecycle_site* currentSite;
+
+thread_counters* registerThread();
+std::size_t registerType(const char* name) noexcept; // overflow_type when the table is full
+
+template <class T>
+std::size_t typeId() {
+	static const std::size_t id = registerType(T::lifecycle_name);
+	return id;
+}
+
+} // namespace lifecycle_detail
+
+// Text of the event written by 'describe(std::ostream&)' when a reporter is installed
+template <class T, class Describe>
+void lifecycle_record(lifecycle_event e, Describe&& describe) {
+	using namespace lifecycle_detail;
+	thread_counters* counters = local != nullptr ? local : registerThread();
+	std::atomic<std::uint64_t>& c = counters->counts[typeId<T>()][static_cast<unsigned>(e)];
+	c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); // Single writer
+	if (currentSite != nullptr) {
+		currentSite->count(e);
+	}
+	if (textOutput != nullptr) {
+		describe(*textOutput);
+		if (textSites && currentSite != nullptr) {
+			*textOutput << " [" << currentSite->where().file << ":" << currentSite->where().line << "]";
+		}
+	}
+}
+
+// Event without text
+template <class T>
+void lifecycle_record(lifecycle_event e) {
+	lifecycle_record<T>(e, [](std::ostream&) {});
+}
+
+// Text only, not counted (e.g. "append move" of string)
+template <class Describe>
+void lifecycle_trace(Describe&& describe) {
+	if (lifecycle_detail::textOutput != nullptr) {
+		describe(*lifecycle_detail::textOutput);
+	}
+}
+
+// Text output of the events of the current thread, while alive (the previous one is restored).
+// With 'sites', each event is followed by the location of the innermost lifecycle_site.
+class lifecycle_text_reporter {
+	std::ostream* previous;
+	bool previousSites;
+
+public:
+	explicit lifecycle_text_reporter(std::ostream& os, bool sites = false);
+	~lifecycle_text_reporter();
+
+	lifecycle_text_reporter(const lifecycle_text_reporter&) = delete;
+	lifecycle_text_reporter& operator=(const lifecycle_text_reporter&) = delete;
+};
+
+// Counts since the creation of the scope, of the current thread only (default) or of all threads
+class lifecycle_scope {
+public:
+	enum threads { current_thread, all_threads };
+
+	explicit lifecycle_scope(threads which = current_thread);
+
+	// Deltas of one type, of all types
+	template <class T>
+	lifecycle_counts delta() const {
+		return delta(lifecycle_detail::typeId<T>());
+	}
+	lifecycle_counts delta() const;
+
+	lifecycle_counts delta(std::size_t typeId) const;
+
+	// Name of each instrumented type and its delta, by name
+	void print(std::ostream& os) const;
+
+private:
+	threads which;
+	lifecycle_counts start[max_lifecycle_types];
+};
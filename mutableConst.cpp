@@ -1,6 +1,25 @@
-#include <iostream>
+#include <atomic>
 #include <cstring>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
 #include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "allocationAudit.h"
+#include "experiments.h"
+#include "fixedString.h"
+#include "immutableString.h"
+#include "internedString.h"
+#include "lazy.h"
+#include "sharedString.h"
+#include "synchronizedMember.h"
+#include "uniqueFunction.h"
+#include "workStealingPool.h"
 
 using std::cout, std::endl, std::mutex, std::lock_guard;
 
@@ -28,6 +47,70 @@ public:
     }
 };
 
+// The same member without the mutex (see synchronizedMember.h): an int is lock free, so
+// synchronized_member<int> is an atomic
+class SyncA
+{
+public:
+    mutable synchronized_member<int> a;
+
+    void f() const {
+        a.store(2);
+    }
+};
+
+struct Point { long x, y; };
+struct Label { char text[80]; };
+
+static_assert(decltype(SyncA::a)::strategy == sync_strategy::atomic);
+static_assert(default_sync_strategy<Point> == sync_strategy::seqlock); // 16 bytes: not lock free on x86-64
+static_assert(default_sync_strategy<Label> == sync_strategy::mutex);   // Too large for a seqlock
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// mutable cache: value computed by a const getter (see lazy.h)
+
+class Document
+{
+public:
+    std::string text;
+    mutable int computations = 0;
+
+    explicit Document(std::string text) : text(std::move(text)) {}
+
+    size_t words() const {
+        return wordCount.get([this] {
+            ++computations;
+            size_t count = 0;
+            bool inWord = false;
+            for (char c : text) {
+                count += !inWord && c != ' ';
+                inWord = c != ' ';
+            }
+            return count;
+        });
+    }
+
+    void append(const std::string& more) {
+        text += more;
+        wordCount.invalidate();
+    }
+
+private:
+    lazy<size_t> wordCount;
+};
+
+void lazyGetter() {
+    Document d("a mutable cache");
+    cout << d.words() << " words / " << d.words() << " words, computed " << d.computations << " time(s)" << endl;
+    d.append(" in a const getter");
+    cout << d.words() << " words, computed " << d.computations << " time(s)" << endl;
+    cout << endl;
+}
+
+// output:
+// 3 words / 3 words, computed 1 time(s)
+// 7 words, computed 2 time(s)
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // mutable lambda
 
@@ -54,93 +137,93 @@ void mutableLambda() {
 // [in lambda] n = 50
 // n = 10
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-// Move semantics with "this" pointer / rvalue reference for *this
-
-class string {
-    char *data;
-
-public:
-
-    string(const char *p) {
-        size_t size = std::strlen(p) + 1;
-        data = new char[size];
-        std::memcpy(data, p, size);
-    }
-
-    ~string() {
-        delete[] data;
-    }
-
-    string(const string &that) {
-        cout << "constructor copy" << endl;
-        size_t size = std::strlen(that.data) + 1;
-        data = new char[size];
-        std::memcpy(data, that.data, size);
-    }
-
-    string(string &&that) {
-        cout << "constructor move" << endl;
-        data = that.data;
-        that.data = nullptr;
-    }
-
-    // Delete operator= for immutablility: "a = b;" forbidden
-    string& operator=(const string& that) = delete;
-
-    // This operator lets the object immutable but it is weird and should not be defined:
-    // a = b;
-    // let 'a' untouched but the expression return a copy of 'b'
-//    string operator=(const string& that) const {
-//        cout << "= copy" << endl;
-//        return string(that);
-//    }
-
-    // string& operator=(string&& that) = delete;
-    //
-    // The object is no longer immutable (keep for the demo), operator= shall be deleted as above
-    //
-    string& operator=(string&& that) {
-        cout << "= move" << endl;
-        std::swap(data, that.data);
-        return *this;
-    }
-
-    // Could NOT be implemented alone, shall come with: string append(const char *p) [const] &;
-	// Incompatible with: string append(const char *p);
-    string& append(const char *p) && {
-        cout << "append move" << endl;
-//        size_t size = std::strlen(data) + std::strlen(p) + 1;
-//        char *tmpData = new char[size];
-//        std::strcpy(tmpData, data);
-//        std::strcat(tmpData, p);
-//
-//        delete[] data;
-//
-//        data = tmpData;
-
-        string tmp(data, p);
-        std::swap(data, tmp.data);
-
-        return *this;
+// A mutable lambda stored for later calls: unique_function (see uniqueFunction.h) accepts move-only
+// captures, std::function requires copyable ones
+void uniqueFunction() {
+    unique_function<void()> counter = [n = std::make_unique<int>(1)]() mutable {
+        *n += 20;
+        cout << "[in lambda] n = " << *n << endl;
+    };
+    counter();
+    unique_function<void()> moved = std::move(counter); // The lambda moves, with its unique_ptr
+    moved();
+    cout << "moved from: " << (counter ? "callable" : "empty") << endl;
+
+    // A string (32 bytes) is stored in the wrapper: no allocation, also when it moves
+    using Length = unique_function<size_t(const char*)>;
+    auto prefixed = [s = string("prefix: ")](const char* p) { return s.size() + std::strlen(p); };
+    const size_t before = thread_allocation_count();
+    Length length = std::move(prefixed);
+    Length length2 = std::move(length);
+    const size_t result = length2("abc");
+    const size_t allocations = thread_allocation_count() - before;
+    cout << "length: " << result << ", allocations: " << allocations << endl;
+
+    auto labelled = [label = Label{"label"}](const char* p) { return std::strlen(label.text) + std::strlen(p); };
+    cout << "inline: " << Length::stores_inline<decltype(prefixed)> << " / "
+         << Length::stores_inline<decltype(labelled)> << " (" << sizeof(labelled) << " bytes)" << endl;
+
+    try {
+        unique_function<void()> none;
+        none();
+    } catch (const std::bad_function_call&) {
+        cout << "empty: bad_function_call" << endl;
     }
+    cout << endl;
+}
 
-    // Could be implemented alone
-    // Incompatible with: string append(const char *p);
-    string append(const char *p) const & {
-        cout << "append copy" << endl;
-        return string(data, p); // RVO
+// output:
+// [in lambda] n = 21
+// [in lambda] n = 41
+// moved from: empty
+// length: 11, allocations: 0
+// inline: 1 / 0 (80 bytes)
+// empty: bad_function_call
+
+// Closures run across cores (see workStealingPool.h): instead of a mutex per object (class A), the
+// tasks share nothing but their results
+void workStealing() {
+    work_stealing_pool pool(4);
+    std::future<size_t> length = pool.submit([s = string("a future")] { return s.size(); });
+
+    std::vector<long> squares(1000);
+    pool.parallel_for(0, squares.size(), [&](size_t i) { squares[i] = long(i * i); });
+    const long sum = pool.parallel_reduce(0, squares.size(), 0L, [&](size_t i) { return squares[i]; }, std::plus<>());
+    cout << "future: " << length.get() << ", sum of squares: " << sum << endl;
+
+    // The partial results are reduced in order: a concatenation is an associative reduce
+    const std::string letters = pool.parallel_reduce(0, 26, std::string(),
+        [](size_t i) { return std::string(1, char('a' + i)); }, std::plus<>(), 3);
+    cout << letters << endl;
+
+    // Nested loops: the thread waiting for the inner loop runs its chunks (or others)
+    std::atomic<int> cells{0};
+    pool.parallel_for(0, 10, [&](size_t) {
+        pool.parallel_for(0, 10, [&](size_t) { cells.fetch_add(1); }, 1);
+    }, 1);
+    cout << "nested: " << cells.load() << " cells" << endl;
+
+    try {
+        pool.parallel_for(0, 100, [](size_t i) {
+            if (i == 42) {
+                throw std::runtime_error("failed at 42");
+            }
+        });
+    } catch (const std::exception& e) {
+        cout << "exception: " << e.what() << endl;
     }
+    cout << endl;
+}
 
-private:
+// output:
+// future: 8, sum of squares: 332833500
+// abcdefghijklmnopqrstuvwxyz
+// nested: 100 cells
+// exception: failed at 42
 
-    string(const char *start, const char *end) {
-        size_t size = std::strlen(start) + std::strlen(end) + 1;
-        data = new char[size];
-        std::strcpy(data, start);
-        std::strcat(data, end);
-    }
-};
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Move semantics with "this" pointer / rvalue reference for *this
+// (string class and its lazy append chain: see immutableString.h)
 
 string f() {
     return string("s").append("1...").append("2...");
@@ -148,6 +231,8 @@ string f() {
 
 void moveSemanticsThis() {
     cout << "Move semantics with \"this\" pointer / rvalue reference for *this" << endl;
+    lifecycle_text_reporter trace(cout); // Print the appends, copies and moves
+    lifecycle_scope scope;
 
     string a("a");
     cout << "b:" << endl;
@@ -166,31 +251,140 @@ void moveSemanticsThis() {
 
     // string g = string("g"); // do not use operator=
 
+    cout << "string copies: " << scope.delta<string>().copies() << endl;
+
     cout << endl;
 }
 
 // output:
 // b:
 // append copy
+// concat 2 pieces
 // c:
 // append copy
-// append move
-// constructor copy
+// concat 3 pieces
 // d:
 // append move
-// append copy
+// concat 3 pieces
 // e:
 // append move
-// append copy
+// concat 3 pieces
 // = move
 // f:
 // append move
+// concat 3 pieces
+// string copies: 0
+//
+// Before string_concat (append returned string / string&), each link of the chain allocated and
+// copied the whole buffer, and "c" needed a copy constructor:
+// c:
 // append copy
+// append move
+// constructor copy
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
+// The same literal chains at compile time (see fixedString.h)
 
-void mutableConst()
-{
-    mutableLambda();
-    moveSemanticsThis();
+constexpr auto fixedB = fixed_string("a").append("...");
+constexpr auto fixedC = fixed_string("a").append("1...").append("2...");
+constexpr auto fixedD = fixed_string("s").append("1...").append("2...");
+constexpr auto fixedLong = fixedD.append(" and a tail too long for the inline buffer");
+
+static_assert(fixedB == "a...");
+static_assert(fixedC == "a1...2...");
+static_assert(fixedD == "s1...2..." && fixedD.size() == 9 && fixedD.capacity() == 9);
+static_assert(fixedD != "s1...");
+static_assert(fixedLong.size() > string::small_capacity);
+
+string fConstexpr() {
+    return fixedD.str(); // Same result as f(): a copy of 9 chars, no concatenation
+}
+
+void compileTimeConcat() {
+    cout << "Compile-time concatenation" << endl;
+    lifecycle_text_reporter trace(cout);
+
+    string d = fixedD.str();
+    string ff = fConstexpr();
+    string tail = fixedLong.borrow(); // References fixedLong: no allocation
+    string copy = tail; // Shares the borrowed chars
+
+    cout << d.c_str() << " / " << ff.c_str() << endl;
+    cout << (copy.c_str() == fixedLong.c_str()) << endl;
+
+    cout << endl;
+}
+
+// output:
+// Compile-time concatenation
+// constructor copy
+// s1...2... / s1...2...
+// 1
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copy on write: copies share the buffer (see sharedString.h)
+
+void sharedString() {
+    cout << "Shared buffer" << endl;
+    lifecycle_text_reporter trace(cout);
+
+    shared_string a("a string long enough to be on the heap");
+    shared_string b = a;
+    cout << "shared: " << (a.c_str() == b.c_str()) << " / count: " << a.use_count() << endl;
+
+    shared_string c = a.append("..."); // New buffer, a and b untouched
+    cout << "count: " << a.use_count() << " / " << c.use_count() << endl;
+
+    shared_string d = std::move(c).append("1..."); // New buffer with room to spare
+    const char *before = d.c_str();
+    shared_string e = std::move(d).append("2..."); // Not shared: in place
+    cout << "in place: " << (e.c_str() == before) << endl;
+
+    cout << endl;
+}
+
+// output:
+// Shared buffer
+// constructor copy (shared)
+// shared: 1 / count: 2
+// count: 2 / 1
+// in place: 1
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Interning: immutable, so equal values can share one canonical entry (see internedString.h)
+
+void interning() {
+    cout << "Interning" << endl;
+
+    std::string name = "request_id";
+    interned_string a("request_id");
+    interned_string b(name); // Another buffer, same value: same entry
+    cout << "same entry: " << (a.c_str() == b.c_str()) << " / equal: " << (a == b) << endl;
+    cout << "cached hash: " << (a.hash() == std::hash<std::string_view>()(name)) << endl;
+
+    // Key of an unordered_map: hash and equality without reading the chars
+    std::unordered_map<interned_string, int> fields;
+    fields[a] = 42;
+    cout << b << ": " << fields[b] << endl;
+
+    cout << endl;
 }
+
+// output:
+// Interning
+// same entry: 1 / equal: 1
+// cached hash: 1
+// request_id: 42
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const experiment_group mutableConstExperiments("mutableConst", {
+    {"lazyGetter", lazyGetter},
+    {"mutableLambda", mutableLambda},
+    {"uniqueFunction", uniqueFunction},
+    {"workStealing", workStealing},
+    {"moveSemanticsThis", moveSemanticsThis},
+    {"compileTimeConcat", compileTimeConcat},
+    {"sharedString", sharedString},
+    {"interning", interning},
+});
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Owner pointer & reference pointers (see thinkingAboutSmartPointer.txt)
+//
+// The owner decides of the beginning and end of life of the object. References cannot delete it.
+// When the owner deletes the object while references are still alive, an exception is thrown.
+//
+// The checks are selected at compile time by a policy:
+// - unchecked_policy: no check at all, ref_ptr is a raw pointer (default with NDEBUG)
+// - counting_policy: the owner counts its references (default without NDEBUG)
+// - atomic_counting_policy: same as counting_policy, references may live in other threads
+
+struct unchecked_policy {
+	static constexpr bool checked = false;
+};
+
+struct counting_policy {
+	static constexpr bool checked = true;
+
+	using counter = std::size_t;
+
+	static void acquire(counter& c) { ++c; }
+	static void release(counter& c) { --c; }
+	static std::size_t count(const counter& c) { return c; }
+};
+
+struct atomic_counting_policy {
+	static constexpr bool checked = true;
+
+	using counter = std::atomic<std::size_t>;
+
+	static void acquire(counter& c) { c.fetch_add(1, std::memory_order_relaxed); }
+	// release: the uses of the object by the reference happen before the owner's check
+	static void release(counter& c) { c.fetch_sub(1, std::memory_order_release); }
+	static std::size_t count(const counter& c) { return c.load(std::memory_order_acquire); }
+};
+
+#ifdef NDEBUG
+using default_ownership_policy = unchecked_policy;
+#else
+using default_ownership_policy = counting_policy;
+#endif
+
+class dangling_reference_error : public std::logic_error {
+public:
+	using std::logic_error::logic_error;
+};
+
+// References count held by the owner and shared with its references.
+// Empty when unchecked: owner_ptr and ref_ptr inherit from it (empty base optimization).
+template <class Policy, bool = Policy::checked>
+class reference_count {
+protected:
+	typename Policy::counter* counter = nullptr;
+
+	reference_count() = default;
+	explicit reference_count(typename Policy::counter* c) : counter(c) {}
+
+	void acquire() const { if (counter != nullptr) Policy::acquire(*counter); }
+	void release() const { if (counter != nullptr) Policy::release(*counter); }
+	std::size_t count() const { return counter != nullptr ? Policy::count(*counter) : 0; }
+};
+
+template <class Policy>
+class reference_count<Policy, false> {
+protected:
+	void acquire() const {}
+	void release() const {}
+	std::size_t count() const { return 0; }
+};
+
+template <class T, class Policy = default_ownership_policy>
+class ref_ptr;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Owner pointer: unique owner of the object (move only, like unique_ptr)
+
+template <class T, class Policy = default_ownership_policy>
+class owner_ptr : private reference_count<Policy> {
+	friend class ref_ptr<T, Policy>;
+
+	T* ptr = nullptr;
+
+public:
+	owner_ptr() = default;
+
+	explicit owner_ptr(T* p) : ptr(p) {
+		if constexpr (Policy::checked) {
+			if (p != nullptr) {
+				this->counter = new typename Policy::counter(0);
+			}
+		}
+	}
+
+	owner_ptr(owner_ptr&& other) noexcept : reference_count<Policy>(other), ptr(other.ptr) {
+		other.ptr = nullptr;
+		if constexpr (Policy::checked) {
+			other.counter = nullptr;
+		}
+	}
+
+	// Throw dangling_reference_error if references are still alive (could not be noexcept).
+	// The object is then leaked on purpose: the remaining references stay usable.
+	owner_ptr& operator=(owner_ptr&& other) noexcept(!Policy::checked) {
+		if (this != &other) {
+			reset();
+			std::swap(ptr, other.ptr);
+			if constexpr (Policy::checked) {
+				std::swap(this->counter, other.counter);
+			}
+		}
+		return *this;
+	}
+
+	// Throw dangling_reference_error if references are still alive, nothing is deleted then.
+	// Throwing while the stack is unwound calls std::terminate.
+	~owner_ptr() noexcept(!Policy::checked) {
+		reset();
+	}
+
+	// Delete the object. Throw dangling_reference_error if references are still alive: the owner
+	// is then left untouched.
+	void reset() {
+		if constexpr (Policy::checked) {
+			if (this->count() != 0) {
+				throw dangling_reference_error("owner_ptr: object deleted while referenced");
+			}
+			delete this->counter;
+			this->counter = nullptr;
+		}
+		delete ptr;
+		ptr = nullptr;
+	}
+
+	// Number of alive references (always 0 when unchecked)
+	std::size_t ref_count() const { return this->count(); }
+
+	T* get() const { return ptr; }
+	T& operator*() const { return *ptr; }
+	T* operator->() const { return ptr; }
+	explicit operator bool() const { return ptr != nullptr; }
+};
+
+template <class T, class Policy = default_ownership_policy, class... Args>
+owner_ptr<T, Policy> make_owner(Args&&... args) {
+	return owner_ptr<T, Policy>(new T(std::forward<Args>(args)...));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Reference pointer: non owning, could not delete the object.
+// Unchecked: exactly a raw pointer. Checked: raw pointer + counter of the owner.
+
+template <class T, class Policy>
+class ref_ptr : private reference_count<Policy> {
+	T* ptr = nullptr;
+
+public:
+	ref_ptr() = default;
+	ref_ptr(std::nullptr_t) {}
+
+	ref_ptr(const owner_ptr<T, Policy>& owner) : reference_count<Policy>(owner), ptr(owner.ptr) {
+		this->acquire();
+	}
+
+	ref_ptr(const ref_ptr& other) : reference_count<Policy>(other), ptr(other.ptr) {
+		this->acquire();
+	}
+
+	ref_ptr(ref_ptr&& other) noexcept : reference_count<Policy>(other), ptr(other.ptr) {
+		other.ptr = nullptr;
+		if constexpr (Policy::checked) {
+			other.counter = nullptr;
+		}
+	}
+
+	ref_ptr& operator=(ref_ptr other) noexcept {
+		std::swap(ptr, other.ptr);
+		if constexpr (Policy::checked) {
+			std::swap(this->counter, other.counter);
+		}
+		return *this;
+	}
+
+	~ref_ptr() {
+		this->release();
+	}
+
+	T* get() const { return ptr; }
+	T& operator*() const { return *ptr; }
+	T* operator->() const { return ptr; }
+	explicit operator bool() const { return ptr != nullptr; }
+};
+
+static_assert(sizeof(ref_ptr<int, unchecked_policy>) == sizeof(int*), "ref_ptr shall be a raw pointer");
+static_assert(sizeof(owner_ptr<int, unchecked_policy>) == sizeof(int*), "owner_ptr shall be a raw pointer");
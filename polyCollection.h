@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Polymorphic collection segregated by dynamic type
+//
+// poly_collection<H> stores the objects of each type derived from H in their own contiguous segment
+// (a std::vector of the concrete type) instead of scattered heap allocations. for_each walks one
+// segment after the other: the calls of a segment all go to the same override (predictable branch,
+// contiguous memory), and for_each<H1, H2>() even gives the concrete type to the function so that
+// the calls could be devirtualized and inlined.
+//
+// The iteration order is by segment (the order of first insertion of each type), not by insertion.
+// As with std::vector, an insertion invalidates the references to the objects of its segment.
+
+template <class Base>
+class poly_collection {
+	// Elements of a segment seen as Base: the address of the first one and the distance between two
+	struct base_range {
+		Base* first;
+		std::size_t stride;
+		std::size_t count;
+	};
+
+	class segment_base {
+	public:
+		virtual ~segment_base() = default;
+		virtual std::unique_ptr<segment_base> clone() const = 0;
+		virtual base_range range() = 0;
+		virtual std::size_t size() const = 0;
+		virtual void clear() = 0;
+	};
+
+	template <class T>
+	class segment final : public segment_base {
+	public:
+		std::vector<T> elements;
+
+		std::unique_ptr<segment_base> clone() const override {
+			return std::make_unique<segment>(*this);
+		}
+		base_range range() override {
+			Base* first = elements.empty() ? nullptr : static_cast<Base*>(elements.data());
+			return {first, sizeof(T), elements.size()};
+		}
+		std::size_t size() const override {
+			return elements.size();
+		}
+		void clear() override {
+			elements.clear();
+		}
+	};
+
+	// A few types per collection: linear search
+	std::vector<std::pair<std::type_index, std::unique_ptr<segment_base>>> segments;
+
+	template <class T>
+	segment<T>& segmentOf() {
+		static_assert(std::is_base_of_v<Base, T>, "poly_collection: not derived from Base");
+		const std::type_index type(typeid(T));
+		for (auto& s : segments) {
+			if (s.first == type) {
+				return static_cast<segment<T>&>(*s.second);
+			}
+		}
+		segments.emplace_back(type, std::make_unique<segment<T>>());
+		return static_cast<segment<T>&>(*segments.back().second);
+	}
+
+	template <class F>
+	static void forEachBase(segment_base& s, F& f) {
+		base_range r = s.range();
+		char* element = reinterpret_cast<char*>(r.first);
+		for (std::size_t i = 0; i < r.count; ++i, element += r.stride) {
+			f(*reinterpret_cast<Base*>(element));
+		}
+	}
+
+	template <class T, class F>
+	static bool forEachOf(std::type_index type, segment_base& s, F& f) {
+		if (type != std::type_index(typeid(T))) {
+			return false;
+		}
+		for (T& element : static_cast<segment<T>&>(s).elements) {
+			f(element);
+		}
+		return true;
+	}
+
+public:
+	poly_collection() = default;
+	poly_collection(poly_collection&&) noexcept = default;
+	poly_collection& operator=(poly_collection&&) noexcept = default;
+
+	poly_collection(const poly_collection& other) {
+		for (const auto& s : other.segments) {
+			segments.emplace_back(s.first, s.second->clone());
+		}
+	}
+
+	poly_collection& operator=(const poly_collection& other) {
+		if (this != &other) {
+			poly_collection copy(other);
+			*this = std::move(copy);
+		}
+		return *this;
+	}
+
+	// 'value' is stored as its static type T: it shall be its dynamic type too (no slicing)
+	template <class T>
+	std::decay_t<T>& insert(T&& value) {
+		using Concrete = std::decay_t<T>;
+		assert(typeid(value) == typeid(Concrete) && "poly_collection: insertion would slice");
+		return segmentOf<Concrete>().elements.emplace_back(std::forward<T>(value));
+	}
+
+	template <class T, class... Args>
+	T& emplace(Args&&... args) {
+		return segmentOf<T>().elements.emplace_back(std::forward<Args>(args)...);
+	}
+
+	// Call f(Base&) on every element, segment by segment
+	template <class F>
+	void for_each(F f) {
+		for (auto& s : segments) {
+			forEachBase(*s.second, f);
+		}
+	}
+
+	// Call f(T&) with the concrete type for the elements of types Ts..., f(Base&) for the others
+	template <class... Ts, class F>
+	std::enable_if_t<(sizeof...(Ts) > 0)> for_each(F f) {
+		for (auto& s : segments) {
+			if (!(forEachOf<Ts>(s.first, *s.second, f) || ...)) {
+				forEachBase(*s.second, f);
+			}
+		}
+	}
+
+	std::size_t size() const {
+		std::size_t count = 0;
+		for (const auto& s : segments) {
+			count += s.second->size();
+		}
+		return count;
+	}
+
+	bool empty() const {
+		return size() == 0;
+	}
+
+	// Keep the segments (and their capacity)
+	void clear() {
+		for (auto& s : segments) {
+			s.second->clear();
+		}
+	}
+};
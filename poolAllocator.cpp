@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+
+#include "poolAllocator.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Global depot + thread caches
+
+namespace {
+
+constexpr std::size_t classCount = 5;             // 16, 32, 64, 128, 256 bytes
+constexpr std::size_t batchSize = 32;              // Blocks moved at once between a thread and the depot
+constexpr std::size_t chunkSize = 64 * 1024;       // Memory requested to the system at once
+
+struct Block {
+	Block* next;
+};
+
+struct Batch {
+	Block* head;
+	std::size_t count;
+};
+
+// First block of a batch kept by the depot: it also links the next batch, so that giving a batch
+// back never allocates (the blocks are at least 16 bytes)
+struct DepotBatch {
+	Block block;                    // Chain of the blocks of the batch, null terminated
+	DepotBatch* nextBatch;
+};
+
+static_assert(sizeof(DepotBatch) <= 16, "DepotBatch shall fit in the smallest block");
+
+std::size_t classOf(std::size_t size) {
+	std::size_t c = 0;
+	std::size_t blockSize = 16;
+	while (blockSize < size) {
+		blockSize *= 2;
+		++c;
+	}
+	return c;
+}
+
+std::size_t blockSizeOf(std::size_t c) {
+	return std::size_t(16) << c;
+}
+
+// Depot of one size class: a stack of batches linked through their first block
+class Depot {
+	std::mutex m;
+	DepotBatch* top = nullptr;
+
+	// m locked
+	void push(Block* head) {
+		DepotBatch* batch = reinterpret_cast<DepotBatch*>(head);
+		batch->nextBatch = top;
+		top = batch;
+	}
+
+	// Carve a new chunk into batches (m locked)
+	void grow(std::size_t blockSize) {
+		char* chunk = static_cast<char*>(std::malloc(chunkSize));
+		if (chunk == nullptr) {
+			throw std::bad_alloc();
+		}
+		const std::size_t blockCount = chunkSize / blockSize;
+		for (std::size_t first = 0; first < blockCount; first += batchSize) {
+			const std::size_t count = std::min(batchSize, blockCount - first);
+			Block* head = nullptr;
+			for (std::size_t i = first + count; i-- > first;) {
+				Block* b = reinterpret_cast<Block*>(chunk + i * blockSize);
+				b->next = head;
+				head = b;
+			}
+			push(head);
+		}
+	}
+
+public:
+	Batch take(std::size_t blockSize) {
+		DepotBatch* batch;
+		{
+			std::lock_guard<std::mutex> lk(m);
+			if (top == nullptr) {
+				grow(blockSize);
+			}
+			batch = top;
+			top = batch->nextBatch;
+		}
+		// The count is not stored: at most 2 * batchSize blocks to walk, outside the lock
+		Batch b = {&batch->block, 0};
+		for (Block* block = b.head; block != nullptr; block = block->next) {
+			++b.count;
+		}
+		return b;
+	}
+
+	// Never allocates: usable by the noexcept deallocations
+	void give(Batch b) noexcept {
+		std::lock_guard<std::mutex> lk(m);
+		push(b.head);
+	}
+};
+
+// Never destroyed: blocks could be deallocated by static destructors
+Depot& depot(std::size_t c) {
+	static Depot* const depots = new Depot[classCount];
+	return depots[c];
+}
+
+// Trivial (constant initialized, no guard), flushed by 'ThreadExit' at the end of the thread
+struct ThreadCache {
+	Block* head[classCount];
+	std::size_t count[classCount];
+	bool exited;
+};
+
+thread_local ThreadCache cache = {};
+
+struct ThreadExit {
+	bool registered = false;
+
+	~ThreadExit() {
+		for (std::size_t c = 0; c < classCount; ++c) {
+			if (cache.head[c] != nullptr) {
+				depot(c).give({cache.head[c], cache.count[c]});
+				cache.head[c] = nullptr;
+				cache.count[c] = 0;
+			}
+		}
+		// Deallocations after this point (thread_local destructors) go directly to the depot
+		cache.exited = true;
+	}
+};
+
+thread_local ThreadExit threadExit;
+
+} // namespace
+
+void* small_object_pool::allocate(std::size_t size) {
+	if (size > max_block_size) {
+		return ::operator new(size);
+	}
+	const std::size_t c = classOf(size);
+	if (cache.exited) {
+		Batch batch = depot(c).take(blockSizeOf(c));
+		if (batch.count > 1) {
+			depot(c).give({batch.head->next, batch.count - 1});
+		}
+		return batch.head;
+	}
+	Block* b = cache.head[c];
+	if (b == nullptr) {
+		if (!threadExit.registered) {
+			threadExit.registered = true; // First use: odr-use registers its destructor
+		}
+		Batch batch = depot(c).take(blockSizeOf(c));
+		b = batch.head;
+		cache.count[c] = batch.count;
+	}
+	cache.head[c] = b->next;
+	--cache.count[c];
+	return b;
+}
+
+void small_object_pool::deallocate(void* p, std::size_t size) noexcept {
+	if (p == nullptr) {
+		return;
+	}
+	if (size > max_block_size) {
+		::operator delete(p);
+		return;
+	}
+	const std::size_t c = classOf(size);
+	Block* b = static_cast<Block*>(p);
+	if (cache.exited) {
+		b->next = nullptr;
+		depot(c).give({b, 1});
+		return;
+	}
+	if (!threadExit.registered) {
+		threadExit.registered = true; // A thread freeing only (blocks of others) flushes at its end too
+	}
+	b->next = cache.head[c];
+	cache.head[c] = b;
+	// Too many free blocks in this thread: give a batch back (blocks freed by another thread than
+	// the allocating one flow back to the depot)
+	if (++cache.count[c] >= 2 * batchSize) {
+		Block* last = b;
+		for (std::size_t i = 1; i < batchSize; ++i) {
+			last = last->next;
+		}
+		cache.head[c] = last->next;
+		last->next = nullptr;
+		cache.count[c] -= batchSize;
+		depot(c).give({b, batchSize});
+	}
+}
+
+void* pool_memory_resource::do_allocate(std::size_t bytes, std::size_t alignment) {
+	if (bytes > small_object_pool::max_block_size || alignment > small_object_pool::block_alignment) {
+		return upstream->allocate(bytes, alignment);
+	}
+	return small_object_pool::allocate(bytes);
+}
+
+void pool_memory_resource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+	if (bytes > small_object_pool::max_block_size || alignment > small_object_pool::block_alignment) {
+		upstream->deallocate(p, bytes, alignment);
+		return;
+	}
+	small_object_pool::deallocate(p, bytes);
+}
+
+bool pool_memory_resource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+	// Every pool_memory_resource uses the same global pool, but not the same upstream
+	const pool_memory_resource* pool = dynamic_cast<const pool_memory_resource*>(&other);
+	return pool != nullptr && pool->upstream->is_equal(*upstream);
+}
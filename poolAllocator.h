@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Pool allocator for small objects (new int, small nodes...)
+//
+// Fixed size classes (16, 32, 64, 128, 256 bytes). Each thread keeps a free list per class: most
+// allocations and deallocations are a pop or a push on it, without lock nor atomic. The lists are
+// refilled from (and flushed to) a global depot, by batches of blocks, under a lock per class.
+// Larger or over-aligned requests go to operator new.
+// The memory of the pool is never given back to the system, only reused.
+
+class small_object_pool {
+public:
+	static constexpr std::size_t max_block_size = 256;
+	static constexpr std::size_t block_alignment = 16;
+
+	// Same contract as operator new / sized operator delete: the size given to deallocate shall be
+	// the one given to allocate
+	static void* allocate(std::size_t size);
+	static void deallocate(void* p, std::size_t size) noexcept;
+};
+
+// Standard allocator (stateless: all instances are equal)
+template <class T>
+class pool_allocator {
+public:
+	using value_type = T;
+	using is_always_equal = std::true_type;
+
+	pool_allocator() = default;
+
+	template <class U>
+	pool_allocator(const pool_allocator<U>&) noexcept {}
+
+	T* allocate(std::size_t n) {
+		if (n > SIZE_MAX / sizeof(T)) {
+			throw std::bad_array_new_length();
+		}
+		if constexpr (alignof(T) > small_object_pool::block_alignment) {
+			return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+		} else {
+			return static_cast<T*>(small_object_pool::allocate(n * sizeof(T)));
+		}
+	}
+
+	void deallocate(T* p, std::size_t n) noexcept {
+		if constexpr (alignof(T) > small_object_pool::block_alignment) {
+			::operator delete(p, n * sizeof(T), std::align_val_t(alignof(T)));
+		} else {
+			small_object_pool::deallocate(p, n * sizeof(T));
+		}
+	}
+
+	friend bool operator==(const pool_allocator&, const pool_allocator&) { return true; }
+	friend bool operator!=(const pool_allocator&, const pool_allocator&) { return false; }
+};
+
+// std::pmr adapter: larger (> max_block_size) or over-aligned requests go to the upstream resource
+class pool_memory_resource : public std::pmr::memory_resource {
+	std::pmr::memory_resource* upstream;
+
+public:
+	explicit pool_memory_resource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+		: upstream(upstream) {}
+
+protected:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+	void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
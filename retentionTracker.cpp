@@ -0,0 +1,287 @@
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define RETENTION_STACKS 1
+#else
+#define RETENTION_STACKS 0
+#endif
+
+#include "retentionTracker.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Registry of the types, of the blocks of the threads and of the sampled sites
+
+namespace retention_detail {
+
+thread_local thread_counters* local = nullptr;
+thread_local std::uint32_t countdown = 0;
+
+} // namespace retention_detail
+
+namespace {
+
+using retention_detail::thread_counters;
+
+std::atomic<std::uint32_t> samplingInterval{1024};
+
+// Stack of sampled constructions, identified by its frames
+struct Site {
+	std::size_t type = 0;
+	void* frames[retention_stack_depth] = {};
+	int depth = 0;
+	std::atomic<std::uint64_t> sampled{0};
+	std::atomic<std::uint64_t> released{0};           // Destroyed by any thread: not single writer
+};
+
+struct Registry {
+	std::mutex m;
+	const char* names[max_retained_types] = {};
+	std::size_t sizes[max_retained_types] = {};
+	std::size_t typeCount = 0;
+	std::vector<thread_counters*> threads;
+	std::uint64_t exitedCreated[max_retained_types] = {};   // Counts of the threads that have ended
+	std::uint64_t exitedDestroyed[max_retained_types] = {};
+
+	Site* sites = new Site[max_retention_sites];      // Site 0: not tracked
+	std::uint32_t siteCount = 1;
+	std::unordered_map<std::uint64_t, std::uint32_t> siteIds;
+};
+
+// Never destroyed: instances can die in static destructors
+Registry& registry() {
+	static Registry* const r = new Registry;
+	return *r;
+}
+
+// Fold the block of the thread into 'exited' at the end of the thread
+struct ThreadExit {
+	bool registered = false;
+
+	~ThreadExit() {
+		thread_counters* counters = retention_detail::local;
+		if (counters == nullptr) {
+			return;
+		}
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lk(r.m);
+		for (std::size_t t = 0; t < r.typeCount; ++t) {
+			r.exitedCreated[t] += counters->created[t].load(std::memory_order_relaxed);
+			r.exitedDestroyed[t] += counters->destroyed[t].load(std::memory_order_relaxed);
+		}
+		for (auto it = r.threads.begin(); it != r.threads.end(); ++it) {
+			if (*it == counters) {
+				r.threads.erase(it);
+				break;
+			}
+		}
+		delete counters;
+		// Events after this point (thread_local destructors) register a new block, never folded
+		retention_detail::local = nullptr;
+	}
+};
+
+thread_local ThreadExit threadExit;
+
+std::uint64_t hashOf(std::size_t type, void* const* frames, int depth) {
+	std::uint64_t h = 14695981039346656037u ^ type;
+	for (int i = 0; i < depth; ++i) {
+		h = (h ^ reinterpret_cast<std::uintptr_t>(frames[i])) * 1099511628211u;
+	}
+	return h;
+}
+
+} // namespace
+
+void retention_sampling(std::uint32_t every) {
+	samplingInterval.store(every, std::memory_order_relaxed);
+	retention_detail::countdown = every == 0 ? UINT32_MAX : every - 1;
+}
+
+std::uint32_t retention_sampling() {
+	return samplingInterval.load(std::memory_order_relaxed);
+}
+
+namespace retention_detail {
+
+thread_counters* registerThread() {
+	thread_counters* counters = new thread_counters();
+	{
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lk(r.m);
+		r.threads.push_back(counters);
+	}
+	if (!threadExit.registered) {
+		threadExit.registered = true; // First use: odr-use registers its destructor
+	}
+	local = counters;
+	return counters;
+}
+
+std::size_t registerType(const char* name, std::size_t size) {
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lk(r.m);
+	if (r.typeCount == max_retained_types) {
+		throw std::length_error("retention tracker: too many tracked types");
+	}
+	r.names[r.typeCount] = name;
+	r.sizes[r.typeCount] = size;
+	return r.typeCount++;
+}
+
+std::uint32_t sampleSite(std::size_t type) {
+	const std::uint32_t every = samplingInterval.load(std::memory_order_relaxed);
+	countdown = every == 0 ? UINT32_MAX : every - 1;
+	if (every == 0) {
+		return 0;
+	}
+	void* frames[retention_stack_depth + 1];
+	int depth = 0;
+#if RETENTION_STACKS
+	depth = backtrace(frames, int(retention_stack_depth + 1)) - 1; // Without sampleSite
+#endif
+	void* const* stack = frames + 1;
+	depth = depth < 0 ? 0 : depth;
+
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lk(r.m);
+	const std::uint64_t h = hashOf(type, stack, depth);
+	auto found = r.siteIds.find(h);
+	std::uint32_t id = found != r.siteIds.end() ? found->second : 0;
+	if (id == 0) {
+		if (r.siteCount == max_retention_sites) {
+			return 0;
+		}
+		id = r.siteCount++;
+		Site& site = r.sites[id];
+		site.type = type;
+		site.depth = depth;
+		for (int i = 0; i < depth; ++i) {
+			site.frames[i] = stack[i];
+		}
+		r.siteIds.emplace(h, id);
+	}
+	r.sites[id].sampled.fetch_add(1, std::memory_order_relaxed);
+	return id;
+}
+
+void releaseSite(std::uint32_t site) {
+	registry().sites[site].released.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace retention_detail
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Snapshots and reports
+
+retention_snapshot retention_snapshot::take() {
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lk(r.m);
+	retention_snapshot s;
+	s.types.resize(r.typeCount);
+	for (std::size_t t = 0; t < r.typeCount; ++t) {
+		std::uint64_t created = r.exitedCreated[t];
+		std::uint64_t destroyed = r.exitedDestroyed[t];
+		for (thread_counters* counters : r.threads) {
+			created += counters->created[t].load(std::memory_order_relaxed);
+			destroyed += counters->destroyed[t].load(std::memory_order_relaxed);
+		}
+		// Another thread may destroy an instance before its creation is seen: never negative
+		s.types[t] = created > destroyed ? created - destroyed : 0;
+	}
+	s.sites.resize(r.siteCount);
+	for (std::uint32_t id = 1; id < r.siteCount; ++id) {
+		const std::uint64_t sampled = r.sites[id].sampled.load(std::memory_order_relaxed);
+		const std::uint64_t released = r.sites[id].released.load(std::memory_order_relaxed);
+		s.sites[id] = sampled > released ? sampled - released : 0;
+	}
+	return s;
+}
+
+void retention_history::record() {
+	snapshots.push_back(retention_snapshot::take());
+}
+
+namespace {
+
+// Count 'index' of every snapshot (0 when not yet registered)
+template <class Member>
+std::vector<std::uint64_t> series(const std::vector<retention_snapshot>& snapshots, Member member, std::size_t index) {
+	std::vector<std::uint64_t> values;
+	for (const retention_snapshot& s : snapshots) {
+		const std::vector<std::uint64_t>& counts = s.*member;
+		values.push_back(index < counts.size() ? counts[index] : 0);
+	}
+	return values;
+}
+
+bool growing(const std::vector<std::uint64_t>& values) {
+	for (std::size_t i = 1; i < values.size(); ++i) {
+		if (values[i] <= values[i - 1]) {
+			return false;
+		}
+	}
+	return values.size() >= 2;
+}
+
+void printSeries(std::ostream& os, const std::vector<std::uint64_t>& values) {
+	const char* separator = "";
+	for (std::uint64_t v : values) {
+		os << separator << v;
+		separator = " -> ";
+	}
+}
+
+} // namespace
+
+void retention_history::print_growing(std::ostream& os, bool stacks) const {
+	(void)stacks; // Without <execinfo.h>: no frame
+	if (snapshots.size() < 2) {
+		return;
+	}
+	Registry& r = registry();
+	const retention_snapshot& last = snapshots.back();
+	for (std::size_t t = 0; t < last.types.size(); ++t) {
+		const std::vector<std::uint64_t> live = series(snapshots, &retention_snapshot::types, t);
+		if (!growing(live)) {
+			continue;
+		}
+		os << r.names[t] << ": live ";
+		printSeries(os, live);
+		os << " (" << live.back() * r.sizes[t] << " bytes)" << std::endl;
+
+		for (std::size_t id = 1; id < last.sites.size(); ++id) {
+			const std::vector<std::uint64_t> sampled = series(snapshots, &retention_snapshot::sites, id);
+			if (r.sites[id].type != t || !growing(sampled)) {
+				continue;
+			}
+			os << "    site " << id << ": sampled live ";
+			printSeries(os, sampled);
+			os << std::endl;
+#if RETENTION_STACKS
+			if (stacks) {
+				char** symbols = backtrace_symbols(r.sites[id].frames, r.sites[id].depth);
+				for (int i = 0; symbols != nullptr && i < r.sites[id].depth; ++i) {
+					os << "        " << symbols[i] << std::endl;
+				}
+				std::free(symbols);
+			}
+#endif
+		}
+	}
+}
+
+void retention_history::print_live(std::ostream& os) const {
+	if (snapshots.empty()) {
+		return;
+	}
+	Registry& r = registry();
+	const retention_snapshot& last = snapshots.back();
+	for (std::size_t t = 0; t < last.types.size(); ++t) {
+		os << r.names[t] << ": " << last.types[t] << " live, " << last.types[t] * r.sizes[t] << " bytes"
+		   << std::endl;
+	}
+}
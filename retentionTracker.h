@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Live objects per type, to find the "long life container" leaks (see thinkingAboutSmartPointer.txt)
+//
+// Opt-in per type, with a mixin inherited privately (as MyMixin in instantiation.cpp):
+//
+// class Session : private retention_tracked<Session> {
+// public:
+//     static constexpr const char* retention_name = "Session";
+// };
+//
+// Each construction (copies and moves too: new instances) and destruction increments a counter of
+// its thread (relaxed atomics written by their thread only, as lifecycleCounters.h): live = created
+// - destroyed, summed over the threads. Bytes are sizeof(T) per instance, not what T owns.
+// One construction out of retention_sampling() of each thread captures its stack: the sites keep
+// the number of their sampled instances still alive.
+// A retention_history records snapshots (e.g. periodically) and prints the types and the sites
+// whose live counts grew at each snapshot: retained by something, most likely forgotten.
+
+constexpr std::size_t max_retained_types = 64;
+constexpr std::size_t max_retention_sites = 4096;
+constexpr std::size_t retention_stack_depth = 8;
+
+// Stack capture every 'every' constructions of each thread (0: never). 1024 by default: a capture
+// costs a few us, ~3 ns per construction on average (see retentionBench.cpp).
+void retention_sampling(std::uint32_t every);
+std::uint32_t retention_sampling();
+
+namespace retention_detail {
+
+// Block of counters of one thread
+struct thread_counters {
+	std::atomic<std::uint64_t> created[max_retained_types];
+	std::atomic<std::uint64_t> destroyed[max_retained_types];
+};
+
+// Constant initialized: no guard on the fast path
+extern thread_local thread_counters* local;
+extern thread_local std::uint32_t countdown;          // Constructions before the next stack capture
+
+thread_counters* registerThread();
+std::size_t registerType(const char* name, std::size_t size);
+
+// Capture the stack of a construction of 'type': id of its site, 0 when not tracked
+std::uint32_t sampleSite(std::size_t type);
+void releaseSite(std::uint32_t site);
+
+template <class T>
+std::size_t typeId() {
+	static const std::size_t id = registerType(T::retention_name, sizeof(T));
+	return id;
+}
+
+inline void increment(std::atomic<std::uint64_t>& c) {
+	c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); // Single writer
+}
+
+} // namespace retention_detail
+
+template <class T>
+class retention_tracked {
+protected:
+	retention_tracked() { created(); }
+	retention_tracked(const retention_tracked&) { created(); }
+	retention_tracked(retention_tracked&&) { created(); }
+
+	// The instance stays the same, and so does its site
+	retention_tracked& operator=(const retention_tracked&) { return *this; }
+	retention_tracked& operator=(retention_tracked&&) { return *this; }
+
+	~retention_tracked() {
+		using namespace retention_detail;
+		thread_counters* counters = local != nullptr ? local : registerThread();
+		increment(counters->destroyed[typeId<T>()]);
+		if (site != 0) {
+			releaseSite(site);
+		}
+	}
+
+private:
+	std::uint32_t site = 0;                           // Sampled: site of the construction
+
+	void created() {
+		using namespace retention_detail;
+		thread_counters* counters = local != nullptr ? local : registerThread();
+		increment(counters->created[typeId<T>()]);
+		if (countdown == 0) {
+			site = sampleSite(typeId<T>());
+		} else {
+			--countdown;
+		}
+	}
+};
+
+// Live counts of each type and of each site at one time
+struct retention_snapshot {
+	std::vector<std::uint64_t> types;                // Live instances, by type id
+	std::vector<std::uint64_t> sites;                // Live sampled instances, by site id
+
+	static retention_snapshot take();
+};
+
+class retention_history {
+public:
+	void record();
+
+	// Types and sites whose live counts grew between each recorded snapshot and the next one
+	// (at least 2 snapshots). With 'stacks', the frames of the growing sites.
+	void print_growing(std::ostream& os, bool stacks = true) const;
+
+	// Live instances and bytes of each type, at the last snapshot
+	void print_live(std::ostream& os) const;
+
+private:
+	std::vector<retention_snapshot> snapshots;
+};
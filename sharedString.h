@@ -0,0 +1,179 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <ostream>
+#include <utility>
+
+#include "lifecycleCounters.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Immutable string with a shared, reference counted buffer (copy on write)
+//
+// Same interface as string (immutableString.h), for values copied often and rarely changed:
+// - a copy shares the buffer and increments its count: O(1), no allocation
+// - append() const & allocates the result only (exact size), the original is untouched
+// - append() && writes in place when the buffer is not shared and large enough (capacity grows
+//   geometrically), as a temporary has no other observer
+// Strings up to small_capacity chars are stored inline, as in string. The count is atomic: copies
+// can be handed to other threads.
+
+class shared_string {
+public:
+
+    static constexpr size_t small_capacity = 23;
+    static constexpr const char *lifecycle_name = "shared_string";
+
+private:
+
+    // Header of the heap buffer, followed by capacity + 1 chars
+    struct shared_buffer {
+        std::atomic<size_t> refs;
+        size_t capacity;
+
+        char* chars() { return reinterpret_cast<char *>(this + 1); }
+
+        static shared_buffer* create(size_t capacity) {
+            void *memory = ::operator new(sizeof(shared_buffer) + capacity + 1);
+            return ::new (memory) shared_buffer{{1}, capacity};
+        }
+    };
+
+    // Active member: 'local' when length <= small_capacity, 'heap' otherwise
+    union storage {
+        shared_buffer *heap;
+        char local[small_capacity + 1];
+    };
+
+    size_t length;
+    storage buf;
+
+public:
+
+    shared_string(const char *p) {
+        const size_t size = std::strlen(p);
+        std::memcpy(init(size, size), p, size);
+        lifecycle_record<shared_string>(lifecycle_event::construction);
+    }
+
+    ~shared_string() {
+        lifecycle_record<shared_string>(lifecycle_event::destruction);
+        release();
+    }
+
+    // O(1): the buffer is shared
+    shared_string(const shared_string &that) noexcept : length(that.length), buf(that.buf) {
+        lifecycle_record<shared_string>(lifecycle_event::copy, [](std::ostream &os) { os << "constructor copy (shared)" << std::endl; });
+        if (!is_small()) {
+            buf.heap->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    shared_string(shared_string &&that) noexcept : length(that.length), buf(that.buf) {
+        lifecycle_record<shared_string>(lifecycle_event::move, [](std::ostream &os) { os << "constructor move" << std::endl; });
+        that.reset();
+    }
+
+    // Immutable: no copy assignment (see string)
+    shared_string& operator=(const shared_string &that) = delete;
+
+    shared_string& operator=(shared_string &&that) noexcept {
+        lifecycle_record<shared_string>(lifecycle_event::move_assignment, [](std::ostream &os) { os << "= move" << std::endl; });
+        std::swap(length, that.length);
+        std::swap(buf, that.buf);
+        return *this;
+    }
+
+    // In place when the buffer is not shared
+    shared_string append(const char *p) && {
+        const size_t pieceSize = std::strlen(p);
+        const size_t size = length + pieceSize;
+        if (size <= small_capacity || (!is_small() && is_unique() && buf.heap->capacity >= size)) {
+            char *data = is_small() ? buf.local : buf.heap->chars();
+            std::memcpy(data + length, p, pieceSize);
+            data[size] = '\0';
+            length = size;
+            return shared_string(take, *this);
+        }
+        // New buffer with room for the next appends (the chain keeps going)
+        return concat(*this, p, pieceSize, size * 2);
+    }
+
+    // Allocate the result only: the original (and its sharers) are untouched
+    shared_string append(const char *p) const & {
+        const size_t pieceSize = std::strlen(p);
+        return concat(*this, p, pieceSize, length + pieceSize);
+    }
+
+    const char* c_str() const {
+        return is_small() ? buf.local : buf.heap->chars();
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    // Number of strings sharing the buffer (1 when inline)
+    size_t use_count() const {
+        return is_small() ? 1 : buf.heap->refs.load(std::memory_order_relaxed);
+    }
+
+private:
+
+    // Move without trace (append() && hands over its own representation)
+    struct take_t {};
+    static constexpr take_t take = {};
+    shared_string(take_t, shared_string &that) noexcept : length(that.length), buf(that.buf) {
+        that.reset();
+        lifecycle_record<shared_string>(lifecycle_event::move);
+    }
+
+    // 'size' chars, 'capacity' allocated, starting with the 'prefixSize' chars of 'prefix'
+    shared_string(size_t size, size_t capacity, const char *prefix, size_t prefixSize) {
+        std::memcpy(init(size, capacity), prefix, prefixSize);
+        lifecycle_record<shared_string>(lifecycle_event::construction);
+    }
+
+    // New string: head + piece, with 'capacity' chars allocated when not inline
+    static shared_string concat(const shared_string &head, const char *p, size_t pieceSize, size_t capacity) {
+        const size_t size = head.length + pieceSize;
+        shared_string result(size, capacity, head.c_str(), head.length);
+        std::memcpy(const_cast<char *>(result.c_str()) + head.length, p, pieceSize);
+        return result; // NRVO
+    }
+
+    bool is_small() const {
+        return length <= small_capacity;
+    }
+
+    bool is_unique() const {
+        return buf.heap->refs.load(std::memory_order_acquire) == 1;
+    }
+
+    void reset() {
+        length = 0;
+        buf.local[0] = '\0';
+    }
+
+    void release() {
+        if (!is_small() && buf.heap->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            buf.heap->~shared_buffer();
+            ::operator delete(buf.heap);
+        }
+    }
+
+    // Set the length, allocate 'capacity' chars if 'size' does not fit inline.
+    // Return the buffer to be filled with 'size' chars, already null terminated.
+    char* init(size_t size, size_t capacity) {
+        length = size;
+        char *data = buf.local;
+        if (!is_small()) {
+            buf.heap = shared_buffer::create(capacity);
+            data = buf.heap->chars();
+        }
+        data[size] = '\0';
+        return data;
+    }
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Slot map: objects stored contiguously, referenced by generational handles
+//
+// An alternative to owner_ptr/ref_ptr (see ownerPtr.h) when the owner is a container: the
+// container owns the objects, a reference is a handle (slot index + generation, 8 bytes) which
+// detects the death of its object instead of dangling.
+// - the objects are contiguous (a vector): iteration is a linear scan
+// - insert, lookup, erase are O(1): a slot gives the position of its object, erase moves the last
+//   object into the hole (swap and pop) and updates its slot
+// - erase increments the generation of the slot: the handles of the erased object are stale,
+//   get() returns nullptr, even after the slot is reused
+// Pointers and references to the objects are invalidated by insert and erase: keep handles.
+
+struct slot_handle {
+	std::uint32_t index = UINT32_MAX;
+	std::uint32_t generation = 0;
+
+	friend bool operator==(slot_handle a, slot_handle b) { return a.index == b.index && a.generation == b.generation; }
+	friend bool operator!=(slot_handle a, slot_handle b) { return !(a == b); }
+};
+
+template <class T>
+class slot_map {
+	// Occupied: position of the object. Free: next free slot.
+	struct slot {
+		std::uint32_t position;
+		std::uint32_t generation;
+	};
+
+	static constexpr std::uint32_t none = UINT32_MAX;
+
+	std::vector<T> objects;
+	std::vector<std::uint32_t> slotOf;       // Slot of each object
+	std::vector<slot> slots;
+	std::uint32_t freeHead = none;
+
+public:
+	using iterator = typename std::vector<T>::iterator;
+	using const_iterator = typename std::vector<T>::const_iterator;
+
+	void reserve(std::size_t n) {
+		objects.reserve(n);
+		slotOf.reserve(n);
+		slots.reserve(n);
+	}
+
+	template <class... Args>
+	slot_handle emplace(Args&&... args) {
+		objects.emplace_back(std::forward<Args>(args)...); // First: if the constructor throws, nothing changed
+		const bool newSlot = freeHead == none;
+		const std::uint32_t index = newSlot ? std::uint32_t(slots.size()) : freeHead;
+		try {
+			if (newSlot) {
+				slots.push_back({0, 0});
+			}
+			slotOf.push_back(index);
+		} catch (...) { // bad_alloc: undo, nothing changed either
+			if (newSlot && slots.size() > index) {
+				slots.pop_back();
+			}
+			objects.pop_back();
+			throw;
+		}
+		if (!newSlot) {
+			freeHead = slots[index].position;
+		}
+		slots[index].position = std::uint32_t(objects.size() - 1);
+		return {index, slots[index].generation};
+	}
+
+	slot_handle insert(T value) {
+		return emplace(std::move(value));
+	}
+
+	// nullptr when the object was erased
+	T* get(slot_handle h) {
+		return contains(h) ? &objects[slots[h.index].position] : nullptr;
+	}
+
+	const T* get(slot_handle h) const {
+		return contains(h) ? &objects[slots[h.index].position] : nullptr;
+	}
+
+	bool contains(slot_handle h) const {
+		return h.index < slots.size() && slots[h.index].generation == h.generation;
+	}
+
+	// false when the object was already erased
+	bool erase(slot_handle h) {
+		if (!contains(h)) {
+			return false;
+		}
+		slot& s = slots[h.index];
+		const std::uint32_t position = s.position;
+		const std::uint32_t last = std::uint32_t(objects.size() - 1);
+		if (position != last) {
+			objects[position] = std::move(objects[last]);
+			slotOf[position] = slotOf[last];
+			slots[slotOf[position]].position = position;
+		}
+		objects.pop_back();
+		slotOf.pop_back();
+		// Last generation: the slot is retired, no handle is ever given with it
+		if (++s.generation != none) {
+			s.position = freeHead;
+			freeHead = h.index;
+		}
+		return true;
+	}
+
+	std::size_t size() const { return objects.size(); }
+	bool empty() const { return objects.empty(); }
+
+	// Objects in storage order (not insertion order)
+	iterator begin() { return objects.begin(); }
+	iterator end() { return objects.end(); }
+	const_iterator begin() const { return objects.begin(); }
+	const_iterator end() const { return objects.end(); }
+
+	// Handle of the object at 'position' of the iteration
+	slot_handle handle_at(std::size_t position) const {
+		const std::uint32_t index = slotOf[position];
+		return {index, slots[index].generation};
+	}
+};
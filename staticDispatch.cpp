@@ -0,0 +1,204 @@
+#include <iostream>
+#include <type_traits>
+#include <variant>
+
+#include "experiments.h"
+
+using std::cout, std::endl;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static dispatch alternatives to the virtual hierarchies of instantiation.cpp
+// Same observable behavior as H -> H1 -> H2 and MyType -> MyTypeImpl, without vtable.
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// H -> H1 -> H2 with std::variant
+// Closed set of types: the "virtual" call is a visit (switch on the index, calls could be inlined)
+
+struct VH1
+{
+	void f()
+	{
+		cout << "H1" << endl;
+	}
+	void g()
+	{
+		cout << "gH1" << endl;
+	}
+};
+
+struct VH2 : VH1
+{
+	void f()
+	{
+		cout << "H2" << endl;
+	}
+	void g()
+	{
+		cout << "gH2" << endl;
+	}
+};
+
+using VH = std::variant<VH1, VH2>;
+
+// Same as the virtual call h->f()
+void f(VH& h) {
+	std::visit([](auto& concrete) { concrete.f(); }, h);
+}
+
+// Same as the non virtual call h1->g() with 'H1* h1': resolved on the static type H1
+void g1(VH& h) {
+	std::visit([](VH1& h1) { h1.g(); }, h);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// H -> H1 -> H2 with CRTP
+// Open set of types but the dynamic type shall be known at compile time (templates)
+
+template <class Derived>
+struct CH
+{
+	void f()
+	{
+		static_cast<Derived*>(this)->fImpl();
+	}
+};
+
+// 'Derived' = void for a CH1 object, otherwise the type inheriting from CH1T
+template <class Derived = void>
+struct CH1T : CH<std::conditional_t<std::is_void_v<Derived>, CH1T<>, Derived>>
+{
+	void fImpl()
+	{
+		cout << "H1" << endl;
+	}
+	void g()
+	{
+		cout << "gH1" << endl;
+	}
+};
+
+using CH1 = CH1T<>;
+
+struct CH2 : CH1T<CH2>
+{
+	void fImpl()
+	{
+		cout << "H2" << endl;
+	}
+	void g()
+	{
+		cout << "gH2" << endl;
+	}
+};
+
+void staticDispatchH() {
+	VH h = VH2();
+	f(h);
+	VH h1 = VH2();
+	f(h1);
+	g1(h1);
+
+	CH2 ch2;
+	CH<CH2>& ch = ch2;
+	ch.f();
+	CH1T<CH2>& ch1 = ch2;
+	ch1.f();
+	ch1.g();
+
+	cout << endl;
+}
+
+// output (same as virtualMethodsBehavior):
+// H2
+// H2
+// gH1
+// H2
+// H2
+// gH1
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// MyType -> MyTypeImpl with CRTP
+// The trait becomes a CRTP base and the mixin a plain private base: no virtual call left.
+
+template <class Derived>
+class CMyType {
+public:
+    void f() const { derived().fImpl(); }
+    void g() const { derived().gImpl(); }
+
+protected:
+    ~CMyType() = default; // No deletion through the base: no virtual destructor required
+
+private:
+    const Derived& derived() const { return static_cast<const Derived&>(*this); }
+};
+
+class CMyMixin {
+private:
+    int z = 0;
+public:
+    void mm() const {}
+};
+
+template <class Derived>
+class CMyTrait {
+public:
+    void gImpl() const {}
+};
+
+class CMyTypeImpl : public CMyType<CMyTypeImpl>, private CMyMixin, public CMyTrait<CMyTypeImpl> {
+private:
+    int a = 0;
+public:
+    void fImpl() const {
+        mm();
+    }
+};
+
+class CMyTypeSubImpl final : public CMyTypeImpl {
+private:
+    int b = 0;
+};
+
+template <class T>
+void useMyType(const CMyType<T>& m) {
+    m.f();
+    m.g();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// MyType -> MyTypeImpl with std::variant
+// The factory returns the variant by value: no heap allocation, no slicing, no dangling reference
+
+using VMyType = std::variant<CMyTypeImpl, CMyTypeSubImpl>;
+
+VMyType buildVariant(bool sub) {
+    if (sub) {
+        return CMyTypeSubImpl();
+    }
+    return CMyTypeImpl();
+}
+
+void staticDispatchMyType() {
+    CMyTypeSubImpl sub;
+    useMyType(sub);
+
+    VMyType m = buildVariant(true);
+    std::visit([](const auto& concrete) { useMyType(concrete); }, m);
+    cout << "sub: " << std::holds_alternative<CMyTypeSubImpl>(m) << endl;
+
+    cout << sizeof(CMyTypeImpl) << " / " << sizeof(CMyTypeSubImpl) << " / " << sizeof(VMyType) << endl;
+
+    cout << endl;
+}
+
+// output:
+// sub: 1
+// 8 / 12 / 16
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const experiment_group staticDispatchExperiments("staticDispatch", {
+	{"staticDispatchH", staticDispatchH},
+	{"staticDispatchMyType", staticDispatchMyType},
+});
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member written by const methods from several threads, without a mutex when T allows it
+//
+// class A {
+//     mutable synchronized_member<int> a;
+//     void f() const { a.store(2); }      // instead of: lock_guard<mutex> lk(m); a = 2;
+// };
+//
+// The strategy is chosen from T at compile time:
+// - atomic: std::atomic<T> when it is always lock free (int, pointers...)
+// - seqlock: other trivially copyable types up to 64 bytes. Readers do not write any shared memory
+//   (no cache line bouncing between them): they copy the value and retry if a write overlapped.
+//   Writers are serialized by the sequence number itself.
+// - mutex: anything else
+//
+// load() returns a copy, update(f) applies f(T&) atomically (under the lock, or in a CAS loop for
+// the atomic strategy: f may then be called several times and shall have no side effect).
+
+enum class sync_strategy { atomic, seqlock, mutex };
+
+namespace synchronized_detail {
+
+template <class T, bool = std::is_trivially_copyable_v<T>>
+struct is_lock_free : std::false_type {};
+
+template <class T>
+struct is_lock_free<T, true> : std::bool_constant<std::atomic<T>::is_always_lock_free> {};
+
+constexpr std::size_t max_seqlock_size = 64;
+
+} // namespace synchronized_detail
+
+template <class T>
+constexpr sync_strategy default_sync_strategy =
+	synchronized_detail::is_lock_free<T>::value ? sync_strategy::atomic
+	: std::is_trivially_copyable_v<T> && sizeof(T) <= synchronized_detail::max_seqlock_size ? sync_strategy::seqlock
+	: sync_strategy::mutex;
+
+template <class T, sync_strategy Strategy = default_sync_strategy<T>>
+class synchronized_member;
+
+template <class T>
+class synchronized_member<T, sync_strategy::atomic> {
+	std::atomic<T> value;
+
+public:
+	static constexpr sync_strategy strategy = sync_strategy::atomic;
+
+	synchronized_member(const T& initial = T()) : value(initial) {}
+
+	T load() const { return value.load(std::memory_order_acquire); }
+	void store(const T& v) { value.store(v, std::memory_order_release); }
+
+	template <class F>
+	void update(F f) {
+		T expected = value.load(std::memory_order_relaxed);
+		T desired;
+		do {
+			desired = expected;
+			f(desired);
+		} while (!value.compare_exchange_weak(expected, desired, std::memory_order_acq_rel,
+		                                      std::memory_order_relaxed));
+	}
+};
+
+template <class T>
+class synchronized_member<T, sync_strategy::seqlock> {
+	static_assert(std::is_trivially_copyable_v<T>, "synchronized_member: seqlock requires a trivially copyable type");
+
+	// The value is copied word by word with relaxed atomics: a read overlapping a write is not a
+	// data race, its torn copy is only discarded
+	static constexpr std::size_t word_count = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+	std::atomic<unsigned> sequence{0}; // Odd while a write is in progress
+	std::atomic<std::uint64_t> words[word_count];
+
+	void write(const T& v) {
+		std::uint64_t buffer[word_count] = {};
+		std::memcpy(buffer, &v, sizeof(T));
+		for (std::size_t i = 0; i < word_count; ++i) {
+			words[i].store(buffer[i], std::memory_order_relaxed);
+		}
+	}
+
+	// T is only required to be trivially copyable, not default constructible: the copy is built in
+	// an aligned buffer
+	T read() const {
+		alignas(T) alignas(std::uint64_t) unsigned char buffer[word_count * sizeof(std::uint64_t)];
+		for (std::size_t i = 0; i < word_count; ++i) {
+			const std::uint64_t word = words[i].load(std::memory_order_relaxed);
+			std::memcpy(buffer + i * sizeof(std::uint64_t), &word, sizeof(word));
+		}
+		return *std::launder(reinterpret_cast<const T*>(buffer));
+	}
+
+	// Wait for the end of any write and make 'sequence' odd: return its even value
+	unsigned beginWrite() {
+		unsigned s = sequence.load(std::memory_order_relaxed);
+		for (;;) {
+			if ((s & 1) == 0 && sequence.compare_exchange_weak(s, s + 1, std::memory_order_acquire,
+			                                                   std::memory_order_relaxed)) {
+				std::atomic_thread_fence(std::memory_order_release); // The words after the odd number
+				return s;
+			}
+			if ((s & 1) != 0) {
+				std::this_thread::yield();
+				s = sequence.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void endWrite(unsigned s) {
+		sequence.store(s + 2, std::memory_order_release);
+	}
+
+	// Ends the write even if update(f) throws: 'sequence' left odd would block every reader and
+	// writer forever. The words are only written after f succeeds, so the old value stays valid.
+	class write_guard {
+		synchronized_member& owner;
+		const unsigned s;
+
+	public:
+		explicit write_guard(synchronized_member& owner) : owner(owner), s(owner.beginWrite()) {}
+		~write_guard() { owner.endWrite(s); }
+
+		write_guard(const write_guard&) = delete;
+		write_guard& operator=(const write_guard&) = delete;
+	};
+
+public:
+	static constexpr sync_strategy strategy = sync_strategy::seqlock;
+
+	synchronized_member(const T& initial = T()) {
+		write(initial);
+	}
+
+	T load() const {
+		for (;;) {
+			const unsigned before = sequence.load(std::memory_order_acquire);
+			if ((before & 1) == 0) {
+				T v = read();
+				std::atomic_thread_fence(std::memory_order_acquire); // The words before the check
+				if (sequence.load(std::memory_order_relaxed) == before) {
+					return v;
+				}
+			} else {
+				std::this_thread::yield(); // The writer could be descheduled
+			}
+		}
+	}
+
+	void store(const T& v) {
+		write_guard guard(*this);
+		write(v);
+	}
+
+	template <class F>
+	void update(F f) {
+		write_guard guard(*this);
+		T v = read();
+		f(v);
+		write(v);
+	}
+};
+
+template <class T>
+class synchronized_member<T, sync_strategy::mutex> {
+	mutable std::mutex m;
+	T value;
+
+public:
+	static constexpr sync_strategy strategy = sync_strategy::mutex;
+
+	synchronized_member(const T& initial = T()) : value(initial) {}
+
+	T load() const {
+		std::lock_guard<std::mutex> lk(m);
+		return value;
+	}
+
+	void store(const T& v) {
+		std::lock_guard<std::mutex> lk(m);
+		value = v;
+	}
+
+	template <class F>
+	void update(F f) {
+		std::lock_guard<std::mutex> lk(m);
+		f(value);
+	}
+};
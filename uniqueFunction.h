@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Move-only std::function with a configurable inline buffer
+//
+// unique_function<R(Args...), InlineBytes> holds any callable, e.g. a mutable lambda capturing a
+// unique_ptr, a string or a B: unlike std::function, the callable need not be copyable.
+// A callable of up to 'InlineBytes' bytes (nothrow movable, not over-aligned) is stored in the
+// object, a larger one on the heap (a move then transfers the pointer).
+// The call is one indirect call through a function pointer held by the object itself: an empty
+// unique_function holds a function that throws std::bad_function_call, no test per call.
+// operator() is not const: a mutable lambda updates its captures across calls.
+//
+// unique_function<void()> f = [p = std::make_unique<int>(1)]() mutable { ++*p; };
+// f();
+
+template <class Signature, std::size_t InlineBytes = 4 * sizeof(void*)>
+class unique_function;
+
+template <class R, class... Args, std::size_t InlineBytes>
+class unique_function<R(Args...), InlineBytes> {
+	static constexpr std::size_t Size = InlineBytes < sizeof(void*) ? sizeof(void*) : InlineBytes;
+
+	using invoker = R (*)(void* storage, Args&&... args);
+
+	// Type erased move and destruction of the stored callable, one table per type
+	struct operations {
+		void (*move)(void* from, void* to) noexcept; // Leaves 'from' destroyed
+		void (*destroy)(void* storage) noexcept;
+	};
+
+	// A void signature discards the result of the callable
+	template <class F>
+	static R call(F& f, Args&&... args) {
+		if constexpr (std::is_void_v<R>) {
+			std::invoke(f, std::forward<Args>(args)...);
+		} else {
+			return std::invoke(f, std::forward<Args>(args)...);
+		}
+	}
+
+	template <class F>
+	struct inline_of {
+		static F* get(void* storage) noexcept { return std::launder(static_cast<F*>(storage)); }
+		static R invoke(void* storage, Args&&... args) {
+			return call(*get(storage), std::forward<Args>(args)...);
+		}
+		static void move(void* from, void* to) noexcept {
+			::new (to) F(std::move(*get(from)));
+			get(from)->~F();
+		}
+		static void destroy(void* storage) noexcept { get(storage)->~F(); }
+		static constexpr operations table = {&move, &destroy};
+	};
+
+	template <class F>
+	struct heap_of {
+		static F*& get(void* storage) noexcept { return *std::launder(static_cast<F**>(storage)); }
+		static R invoke(void* storage, Args&&... args) {
+			return call(*get(storage), std::forward<Args>(args)...);
+		}
+		static void move(void* from, void* to) noexcept { ::new (to) F*(get(from)); }
+		static void destroy(void* storage) noexcept { delete get(storage); }
+		static constexpr operations table = {&move, &destroy};
+	};
+
+	struct empty {
+		[[noreturn]] static R invoke(void*, Args&&...) { throw std::bad_function_call(); }
+		static void move(void*, void*) noexcept {}
+		static void destroy(void*) noexcept {}
+		static constexpr operations table = {&move, &destroy};
+	};
+
+	template <class F>
+	using storage_of = std::conditional_t<sizeof(F) <= Size && alignof(F) <= alignof(std::max_align_t)
+	                                      && std::is_nothrow_move_constructible_v<F>,
+	                                      inline_of<F>, heap_of<F>>;
+
+	alignas(std::max_align_t) unsigned char storage[Size];
+	invoker invoke = &empty::invoke;
+	const operations* ops = &empty::table;
+
+	template <class F>
+	static bool isNull(const F& f) noexcept {
+		if constexpr (std::is_pointer_v<F> || std::is_member_pointer_v<F>) {
+			return f == nullptr;
+		} else {
+			return false;
+		}
+	}
+
+	template <class F, class... CArgs>
+	void construct(CArgs&&... args) {
+		using S = storage_of<F>;
+		if constexpr (std::is_same_v<S, inline_of<F>>) {
+			::new (static_cast<void*>(storage)) F(std::forward<CArgs>(args)...);
+		} else {
+			::new (static_cast<void*>(storage)) F*(new F(std::forward<CArgs>(args)...));
+		}
+		invoke = &S::invoke;
+		ops = &S::table;
+	}
+
+	void clear() noexcept {
+		ops->destroy(storage);
+		invoke = &empty::invoke;
+		ops = &empty::table;
+	}
+
+public:
+	// Whether a callable of type F is stored in the object
+	template <class F>
+	static constexpr bool stores_inline = std::is_same_v<storage_of<std::decay_t<F>>, inline_of<std::decay_t<F>>>;
+
+	unique_function() noexcept = default;
+	unique_function(std::nullptr_t) noexcept {}
+
+	// A null function pointer makes an empty unique_function
+	template <class F, class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, unique_function>
+	                                            && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>>>
+	unique_function(F&& f) {
+		if (!isNull(f)) {
+			construct<std::decay_t<F>>(std::forward<F>(f));
+		}
+	}
+
+	template <class F, class... CArgs>
+	explicit unique_function(std::in_place_type_t<F>, CArgs&&... args) {
+		construct<F>(std::forward<CArgs>(args)...);
+	}
+
+	unique_function(const unique_function&) = delete;
+	unique_function& operator=(const unique_function&) = delete;
+
+	// 'other' is left empty
+	unique_function(unique_function&& other) noexcept : invoke(other.invoke), ops(other.ops) {
+		ops->move(other.storage, storage);
+		other.invoke = &empty::invoke;
+		other.ops = &empty::table;
+	}
+
+	unique_function& operator=(unique_function&& other) noexcept {
+		if (this != &other) {
+			ops->destroy(storage);
+			invoke = other.invoke;
+			ops = other.ops;
+			ops->move(other.storage, storage);
+			other.invoke = &empty::invoke;
+			other.ops = &empty::table;
+		}
+		return *this;
+	}
+
+	unique_function& operator=(std::nullptr_t) noexcept {
+		clear();
+		return *this;
+	}
+
+	~unique_function() {
+		ops->destroy(storage);
+	}
+
+	explicit operator bool() const noexcept { return ops != &empty::table; }
+
+	R operator()(Args... args) {
+		return invoke(storage, std::forward<Args>(args)...);
+	}
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Move-only owner of one value, stored inline when small (B without its heap int)
+//
+// Same semantics as B (instrumentedTypes.h) and unique_ptr: not copyable, a move transfers the
+// value and leaves the source empty, the move assignment destroys the previous value.
+// A small, nothrow movable T (e.g. int) is stored in the object: no allocation, no indirection,
+// and moving moves the T itself. Otherwise T is on the heap and a move transfers the pointer
+// (T may then be large, not movable or throw on move).
+
+template <class T, std::size_t InlineBytes = 2 * sizeof(void*)>
+class unique_value;
+
+namespace unique_value_detail {
+
+// T in the object, with a flag for the empty state
+template <class T>
+class inline_storage {
+	alignas(T) unsigned char bytes[sizeof(T)];
+	bool engaged = false;
+
+public:
+	T* get() noexcept { return engaged ? std::launder(reinterpret_cast<T*>(bytes)) : nullptr; }
+	const T* get() const noexcept { return engaged ? std::launder(reinterpret_cast<const T*>(bytes)) : nullptr; }
+
+	template <class... Args>
+	void emplace(Args&&... args) {
+		::new (static_cast<void*>(bytes)) T(std::forward<Args>(args)...);
+		engaged = true;
+	}
+
+	void reset() noexcept {
+		if (engaged) {
+			get()->~T();
+			engaged = false;
+		}
+	}
+
+	// Empty *this: move the value of 'other', which becomes empty
+	void take(inline_storage& other) noexcept {
+		if (other.engaged) {
+			emplace(std::move(*other.get()));
+			other.reset();
+		}
+	}
+};
+
+// T on the heap, nullptr when empty
+template <class T>
+class heap_storage {
+	T* p = nullptr;
+
+public:
+	T* get() noexcept { return p; }
+	const T* get() const noexcept { return p; }
+
+	template <class... Args>
+	void emplace(Args&&... args) {
+		p = new T(std::forward<Args>(args)...);
+	}
+
+	void reset() noexcept {
+		delete p;
+		p = nullptr;
+	}
+
+	void take(heap_storage& other) noexcept {
+		p = other.p;
+		other.p = nullptr;
+	}
+};
+
+} // namespace unique_value_detail
+
+template <class T, std::size_t InlineBytes>
+class unique_value {
+public:
+	static constexpr bool is_inline = sizeof(T) <= InlineBytes && alignof(T) <= alignof(std::max_align_t)
+	                                  && std::is_nothrow_move_constructible<T>::value;
+
+private:
+	using storage = std::conditional_t<is_inline, unique_value_detail::inline_storage<T>,
+	                                   unique_value_detail::heap_storage<T>>;
+	storage s;
+
+public:
+	// Empty
+	unique_value() noexcept = default;
+
+	template <class... Args>
+	explicit unique_value(std::in_place_t, Args&&... args) {
+		s.emplace(std::forward<Args>(args)...);
+	}
+
+	~unique_value() {
+		s.reset();
+	}
+
+	unique_value(const unique_value&) = delete;
+	unique_value& operator=(const unique_value&) = delete;
+
+	unique_value(unique_value&& other) noexcept {
+		s.take(other.s);
+	}
+
+	unique_value& operator=(unique_value&& other) noexcept {
+		if (this != &other) {
+			s.reset();
+			s.take(other.s);
+		}
+		return *this;
+	}
+
+	template <class... Args>
+	T& emplace(Args&&... args) {
+		s.reset();
+		s.emplace(std::forward<Args>(args)...);
+		return *s.get();
+	}
+
+	void reset() noexcept {
+		s.reset();
+	}
+
+	bool has_value() const noexcept { return s.get() != nullptr; }
+	explicit operator bool() const noexcept { return has_value(); }
+
+	// nullptr when empty (moved from)
+	T* get() noexcept { return s.get(); }
+	const T* get() const noexcept { return s.get(); }
+
+	T& operator*() noexcept { return *s.get(); }
+	const T& operator*() const noexcept { return *s.get(); }
+	T* operator->() noexcept { return s.get(); }
+	const T* operator->() const noexcept { return s.get(); }
+};
+
+template <class T, class... Args>
+unique_value<T> make_unique_value(Args&&... args) {
+	return unique_value<T>(std::in_place, std::forward<Args>(args)...);
+}
@@ -0,0 +1,253 @@
+#include <functional>
+
+#include "workStealingPool.h"
+
+using work_stealing_detail::chase_lev_deque;
+using work_stealing_detail::inbox;
+using work_stealing_detail::task;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Chase-Lev deque
+
+chase_lev_deque::chase_lev_deque(std::int64_t capacity) {
+	arrays.push_back(std::make_unique<array>(capacity));
+	items.store(arrays.back().get(), std::memory_order_relaxed);
+}
+
+void chase_lev_deque::push(task* t) {
+	const std::int64_t b = bottom.load(std::memory_order_relaxed);
+	const std::int64_t tp = top.load(std::memory_order_acquire);
+	array* a = items.load(std::memory_order_relaxed);
+	if (b - tp > a->capacity - 1) {
+		auto grown = std::make_unique<array>(a->capacity * 2);
+		for (std::int64_t i = tp; i < b; ++i) {
+			grown->put(i, a->get(i));
+		}
+		a = grown.get();
+		arrays.push_back(std::move(grown));
+		items.store(a, std::memory_order_release);
+	}
+	a->put(b, t);
+	bottom.store(b + 1, std::memory_order_release);
+}
+
+task* chase_lev_deque::pop() {
+	const std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+	array* a = items.load(std::memory_order_relaxed);
+	bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	std::int64_t tp = top.load(std::memory_order_relaxed);
+	if (tp > b) { // Empty
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+	task* t = a->get(b);
+	if (tp == b) { // Last one: race with the thieves
+		if (!top.compare_exchange_strong(tp, tp + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			t = nullptr;
+		}
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+	return t;
+}
+
+task* chase_lev_deque::steal() {
+	for (;;) {
+		std::int64_t tp = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const std::int64_t b = bottom.load(std::memory_order_acquire);
+		if (tp >= b) {
+			return nullptr;
+		}
+		task* t = items.load(std::memory_order_acquire)->get(tp);
+		if (top.compare_exchange_strong(tp, tp + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return t;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Inbox
+
+inbox::inbox() : head(&stub), tail(&stub) {}
+
+void inbox::push(task* t) {
+	t->next.store(nullptr, std::memory_order_relaxed);
+	task* previous = head.exchange(t, std::memory_order_acq_rel);
+	previous->next.store(t, std::memory_order_release);
+}
+
+task* inbox::try_pop() {
+	if (consuming.load(std::memory_order_relaxed) || consuming.exchange(true, std::memory_order_acquire)) {
+		return nullptr;
+	}
+	task* t = popConsumed();
+	consuming.store(false, std::memory_order_release);
+	return t;
+}
+
+// nullptr also while a producer is between its exchange and its link: the task is seen by the next
+// try_pop
+task* inbox::popConsumed() {
+	task* t = tail;
+	task* next = t->next.load(std::memory_order_acquire);
+	if (t == &stub) {
+		if (next == nullptr) {
+			return nullptr;
+		}
+		tail = next;
+		t = next;
+		next = next->next.load(std::memory_order_acquire);
+	}
+	if (next != nullptr) {
+		tail = next;
+		return t;
+	}
+	if (t != head.load(std::memory_order_acquire)) {
+		return nullptr;
+	}
+	push(&stub); // t is the last one: the stub takes its place
+	next = t->next.load(std::memory_order_acquire);
+	if (next != nullptr) {
+		tail = next;
+		return t;
+	}
+	return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Pool
+
+namespace {
+
+struct current_worker {
+	const work_stealing_pool* pool = nullptr;
+	std::size_t index = 0;
+};
+
+thread_local current_worker current;
+
+// Round robin of the inboxes and start of the steals, per thread: no shared counter
+thread_local std::size_t nextVictim = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+// Spins of an idle worker before it sleeps
+const int idleSpins = 64;
+
+} // namespace
+
+work_stealing_pool::work_stealing_pool(unsigned threadCount)
+	: workerCount(threadCount), workers(new worker[threadCount]) {
+	threads.reserve(threadCount);
+	for (unsigned i = 0; i < threadCount; ++i) {
+		threads.emplace_back([this, i] { workerLoop(i); });
+	}
+}
+
+work_stealing_pool::~work_stealing_pool() {
+	{
+		std::lock_guard<std::mutex> lock(sleepLock);
+		stopping.store(true);
+	}
+	wakeUp.notify_all();
+	for (std::thread& t : threads) {
+		t.join();
+	}
+}
+
+std::size_t work_stealing_pool::self() const {
+	return current.pool == this ? current.index : none;
+}
+
+void work_stealing_pool::push(task* t) {
+	if (workerCount == 0) {
+		run(t);
+		return;
+	}
+	const std::size_t index = self();
+	if (index != none) {
+		workers[index].deque.push(t);
+	} else {
+		workers[nextVictim++ % size()].inbox.push(t);
+	}
+	// Against the fence of a worker going to sleep: either it sees the task, or this sees it asleep
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (sleepers.load(std::memory_order_relaxed) != 0) {
+		{
+			std::lock_guard<std::mutex> lock(sleepLock);
+		}
+		wakeUp.notify_one();
+	}
+}
+
+task* work_stealing_pool::findTask(std::size_t index) {
+	if (index != none) {
+		if (task* t = workers[index].deque.pop()) {
+			return t;
+		}
+		if (task* t = workers[index].inbox.try_pop()) {
+			return t;
+		}
+	}
+	const std::size_t start = nextVictim++;
+	for (std::size_t k = 0; k < size(); ++k) {
+		const std::size_t victim = (start + k) % size();
+		if (victim == index) {
+			continue;
+		}
+		if (task* t = workers[victim].deque.steal()) {
+			return t;
+		}
+		if (task* t = workers[victim].inbox.try_pop()) {
+			return t;
+		}
+	}
+	return nullptr;
+}
+
+void work_stealing_pool::run(task* t) {
+	t->run();
+	delete t;
+}
+
+void work_stealing_pool::helpUntilDone(const std::atomic<std::size_t>& remaining) {
+	const std::size_t index = self();
+	while (remaining.load(std::memory_order_acquire) != 0) {
+		if (task* t = findTask(index)) {
+			run(t);
+		} else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void work_stealing_pool::workerLoop(std::size_t index) {
+	current = {this, index};
+	for (;;) {
+		task* t = findTask(index);
+		for (int spin = 0; t == nullptr && spin < idleSpins; ++spin) {
+			std::this_thread::yield();
+			t = findTask(index);
+		}
+		if (t == nullptr) {
+			std::unique_lock<std::mutex> lock(sleepLock);
+			sleepers.fetch_add(1);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			t = findTask(index);
+			if (t == nullptr && !stopping.load()) {
+				wakeUp.wait(lock);
+			}
+			sleepers.fetch_sub(1);
+			if (t == nullptr && stopping.load()) {
+				lock.unlock();
+				// The tasks submitted before the destruction are run
+				while ((t = findTask(index)) != nullptr) {
+					run(t);
+				}
+				return;
+			}
+		}
+		if (t != nullptr) {
+			run(t);
+		}
+	}
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "uniqueFunction.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Work-stealing thread pool
+//
+// Each worker owns a Chase-Lev deque: it pushes and pops its tasks at the bottom (LIFO, hot in
+// cache) without lock and, when out of work, steals from the top of the others (the oldest
+// tasks). A thread outside the pool submits to the inbox of one worker (round robin), a lock-free
+// multi-producer queue: no global lock nor shared counter on the submission path. The inboxes are
+// drained by their worker, or by any idle thread.
+// Idle workers spin briefly, then sleep: a submission takes the sleep lock only when a worker
+// sleeps.
+//
+// work_stealing_pool pool(4);
+// std::future<int> f = pool.submit([] { return 42; });
+// pool.parallel_for(0, v.size(), [&](std::size_t i) { v[i] *= 2; });
+// long sum = pool.parallel_reduce(0, v.size(), 0L, [&](std::size_t i) { return long(v[i]); }, std::plus<>());
+//
+// post() runs a task without result (it shall not throw: std::terminate); submit() returns a future
+// (which gets the exception). A task is one allocation (its node, holding a unique_function).
+// parallel_for and parallel_reduce split the range into chunks, the calling thread runs some of
+// them and helps (runs any task of the pool) until all are done: they can be nested in tasks.
+// They rethrow the first exception of the body.
+// Waiting on a future inside a task blocks its worker: prefer parallel_for/parallel_reduce.
+// A pool of 0 threads runs the tasks in the submitting thread.
+
+namespace work_stealing_detail {
+
+struct task {
+	unique_function<void()> run;
+	std::atomic<task*> next{nullptr};       // Of the inbox
+};
+
+// Chase-Lev deque (Le, Pop, Cohen, Zappa Nardelli: "Correct and efficient work-stealing for weak
+// memory models", 2013). push and pop by the owner only, steal by any thread.
+// The array grows (doubles) when full; the previous arrays are kept until the destruction, a
+// thief may still read them.
+class chase_lev_deque {
+	struct array {
+		std::int64_t capacity;              // Power of two
+		std::unique_ptr<std::atomic<task*>[]> slots;
+
+		explicit array(std::int64_t capacity)
+			: capacity(capacity), slots(new std::atomic<task*>[std::size_t(capacity)]) {}
+
+		task* get(std::int64_t i) const { return slots[std::size_t(i & (capacity - 1))].load(std::memory_order_relaxed); }
+		void put(std::int64_t i, task* t) { slots[std::size_t(i & (capacity - 1))].store(t, std::memory_order_relaxed); }
+	};
+
+	alignas(64) std::atomic<std::int64_t> top{0};
+	alignas(64) std::atomic<std::int64_t> bottom{0};
+	std::atomic<array*> items;
+	std::vector<std::unique_ptr<array>> arrays; // Current and previous ones (owner only)
+
+public:
+	explicit chase_lev_deque(std::int64_t capacity = 1024);
+
+	void push(task* t);
+	task* pop();
+	// nullptr when empty (retries when another thief wins the race)
+	task* steal();
+};
+
+// Intrusive multi-producer queue (Vyukov): push is one exchange, pop by one consumer at a time
+// (try_pop gives up when another thread consumes)
+class inbox {
+	alignas(64) std::atomic<task*> head;
+	alignas(64) task* tail;
+	std::atomic<bool> consuming{false};
+	task stub;
+
+	task* popConsumed();
+
+public:
+	inbox();
+
+	void push(task* t);
+	task* try_pop();
+};
+
+// Partial result of a chunk of parallel_reduce, on its own cache line: no false sharing between
+// the chunks, and one object per chunk (a std::vector<bool> would pack several chunks in a word)
+template <class T>
+struct alignas(64) chunk_result {
+	T value;
+};
+
+} // namespace work_stealing_detail
+
+class work_stealing_pool {
+public:
+	explicit work_stealing_pool(unsigned threads = std::max(1u, std::thread::hardware_concurrency()));
+	// Runs the remaining tasks, then joins the workers
+	~work_stealing_pool();
+
+	work_stealing_pool(const work_stealing_pool&) = delete;
+	work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+	std::size_t size() const { return workerCount; }
+
+	template <class F>
+	void post(F&& f) {
+		auto* t = new work_stealing_detail::task{unique_function<void()>(std::forward<F>(f))};
+		push(t);
+	}
+
+	template <class F>
+	auto submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+		std::packaged_task<std::invoke_result_t<std::decay_t<F>&>()> job(std::forward<F>(f));
+		auto result = job.get_future();
+		post([job = std::move(job)]() mutable { job(); });
+		return result;
+	}
+
+	// body(i) for each i of [begin, end), by chunks of 'grain' indices (0: about 8 chunks per thread)
+	template <class F>
+	void parallel_for(std::size_t begin, std::size_t end, F&& body, std::size_t grain = 0) {
+		forChunks(begin, end, grain, [&](std::size_t, std::size_t b, std::size_t e) {
+			for (std::size_t i = b; i < e; ++i) {
+				body(i);
+			}
+		});
+	}
+
+	// reduce of map(i) over [begin, end), from 'identity'. The partial results of the chunks are
+	// reduced in the order of the range: 'reduce' shall be associative, not commutative.
+	template <class T, class Map, class Reduce>
+	T parallel_reduce(std::size_t begin, std::size_t end, T identity, Map&& map, Reduce&& reduce,
+	                  std::size_t grain = 0) {
+		using work_stealing_detail::chunk_result;
+		std::vector<chunk_result<T>> partial(chunkCount(begin, end, grain), chunk_result<T>{identity});
+		forChunks(begin, end, grain, [&](std::size_t chunk, std::size_t b, std::size_t e) {
+			T value = identity;
+			for (std::size_t i = b; i < e; ++i) {
+				value = reduce(std::move(value), map(i));
+			}
+			partial[chunk].value = std::move(value);
+		});
+		for (chunk_result<T>& result : partial) {
+			identity = reduce(std::move(identity), std::move(result.value));
+		}
+		return identity;
+	}
+
+private:
+	struct alignas(64) worker {
+		work_stealing_detail::chase_lev_deque deque;
+		work_stealing_detail::inbox inbox;
+	};
+
+	// Shared by the chunks of a parallel_for: on the stack of the caller
+	struct for_state {
+		std::size_t begin, end, grain;
+		std::atomic<std::size_t> remaining;
+		std::atomic<bool> failed{false};
+		std::exception_ptr error;
+	};
+
+	static constexpr std::size_t none = SIZE_MAX;
+
+	const std::size_t workerCount;          // Not threads.size(): read by the workers while it grows
+	std::unique_ptr<worker[]> workers;
+	std::vector<std::thread> threads;
+	std::mutex sleepLock;
+	std::condition_variable wakeUp;
+	std::atomic<unsigned> sleepers{0};
+	std::atomic<bool> stopping{false};
+
+	void push(work_stealing_detail::task* t);
+	// Index of the calling thread in this pool, none for an outside thread
+	std::size_t self() const;
+	work_stealing_detail::task* findTask(std::size_t self);
+	static void run(work_stealing_detail::task* t);
+	// Runs tasks until 'remaining' is 0
+	void helpUntilDone(const std::atomic<std::size_t>& remaining);
+	void workerLoop(std::size_t index);
+
+	std::size_t grainOf(std::size_t begin, std::size_t end, std::size_t grain) const {
+		return grain != 0 ? grain : std::max<std::size_t>(1, (end - begin) / (8 * (size() + 1)));
+	}
+
+	std::size_t chunkCount(std::size_t begin, std::size_t end, std::size_t grain) const {
+		const std::size_t g = grainOf(begin, end, grain);
+		return begin < end ? (end - begin + g - 1) / g : 0;
+	}
+
+	// chunkBody(chunk, b, e) for each chunk of [begin, end): chunk 0 by the caller, the others posted
+	template <class ChunkBody>
+	void forChunks(std::size_t begin, std::size_t end, std::size_t grain, ChunkBody chunkBody) {
+		const std::size_t chunks = chunkCount(begin, end, grain);
+		if (chunks == 0) {
+			return;
+		}
+		for_state state{begin, end, grainOf(begin, end, grain), {chunks}, {false}, nullptr};
+		auto runChunk = [&state, &chunkBody](std::size_t chunk) noexcept {
+			const std::size_t b = state.begin + chunk * state.grain;
+			try {
+				chunkBody(chunk, b, std::min(state.end, b + state.grain));
+			} catch (...) {
+				if (!state.failed.exchange(true)) {
+					state.error = std::current_exception();
+				}
+			}
+			state.remaining.fetch_sub(1, std::memory_order_release);
+		};
+		if (size() == 0) {
+			for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+				runChunk(chunk);
+			}
+		} else {
+			for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+				post([&runChunk, chunk] { runChunk(chunk); });
+			}
+			runChunk(0);
+			helpUntilDone(state.remaining);
+		}
+		if (state.error) {
+			std::rethrow_exception(state.error);
+		}
+	}
+};